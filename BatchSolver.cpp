@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Common.h"
+
+#include "BatchSolver.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Puzzles are read, solved and written this many at a time
+#define BATCH_BLOCK_SIZE					65536
+
+// Puzzles per unit of work handed out by the scheduler
+#define BATCH_CHUNK_SIZE					16
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Collect the cells on the next line of the stream (up to PUZZLE_STRING_LENGTH of them) into cells[].
+// return the number of cells on the line, all of them counted, or -1 at the end of the stream
+int PuzzleReader::readLine (char cells[PUZZLE_STRING_LENGTH]) {
+	int c = getc(m_fp);
+	if (c == EOF) {
+		return -1;
+	}
+
+	m_lineNumber++;
+
+	// the rest of a comment is skipped
+	bool comment = (c == '#');
+
+	int numCells = 0;
+	for (; (c != EOF) && (c != '\n'); c = getc(m_fp)) {
+		char cell;
+		if (comment) {
+			continue;
+		} else if ((c >= '1') && (c <= '9')) {
+			cell = c;
+		} else if ((c == '-') || (c == '.') || (c == '0')) {
+			cell = '-';
+		} else {
+			// anything else is window dressing
+			continue;
+		}
+
+		if (numCells < PUZZLE_STRING_LENGTH) {
+			cells[numCells] = cell;
+		}
+		numCells++;
+	}
+
+	return numCells;
+}
+
+bool PuzzleReader::getNextPuzzle (char puzzle[PUZZLE_STRING_LENGTH+1]) {
+	int numCells;
+	while ((numCells = readLine(puzzle)) >= 0) {
+		if (numCells == PUZZLE_STRING_LENGTH) {
+			puzzle[numCells] = '\0';
+			return true;
+		}
+
+		// n.b., a bad line is dropped on its own, rather than run into the next one
+		// (which would throw every puzzle after it out of step)
+		if (numCells != 0) {
+			TRACE(0, "Error: line %d has %d cells, not %d (skipped)\n", m_lineNumber, numCells, PUZZLE_STRING_LENGTH);
+		}
+	}
+
+	return false;
+}
+
+FILE* openPuzzleFile (const char* filename) {
+	FILE* fp = (strcmp(filename, "-") == 0) ? stdin : fopen(filename, "r");
+	if (!fp) {
+		TRACE(0, "Error: unable to open \"%s\"\n", filename);
+	}
+
+	return fp;
+}
+
+void closePuzzleFile (FILE* fp) {
+	if (fp != stdin) {
+		fclose(fp);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BatchSolver::BatchSolver (int numThreads) : m_scheduler(numThreads) {
+	for (int i=0; i<m_scheduler.getNumThreads(); i++) {
+		m_solvers.push_back(new SudokuSolver());
+	}
+
+	m_propagationStats.resize(m_solvers.size());
+	m_solverStats.resize(m_solvers.size());
+
+	m_numPuzzles = 0;
+	m_numSolved = 0;
+	m_elapsedTime = 0;
+}
+
+BatchSolver::~BatchSolver () {
+	for (int i=0; i<m_solvers.size(); i++) {
+		delete m_solvers[i];
+	}
+}
+
+void BatchSolver::setSolveMethod (SolveMethodType solveMethod) {
+	for (int i=0; i<m_solvers.size(); i++) {
+		m_solvers[i]->setSolveMethod(solveMethod);
+	}
+}
+
+void BatchSolver::setUseChains (bool useChains) {
+	for (int i=0; i<m_solvers.size(); i++) {
+		m_solvers[i]->setUseChains(useChains);
+	}
+}
+
+// Solve a single puzzle with the given (per-worker) SudokuSolver.
+// return false if it has no solution (or breaks the rules to begin with), otherwise the solution is in entry->m_solution
+bool BatchSolver::solvePuzzle (SudokuSolver* solver, BatchEntry* entry) {
+	if (solver->loadGameString(entry->m_puzzle) < 0) {
+		return false;
+	}
+
+	solver->solve();
+	solver->getGameString(entry->m_solution);
+
+	return solver->isSolved();
+}
+
+void BatchSolver::solveBlock (int numEntries) {
+	m_scheduler.run(numEntries, BATCH_CHUNK_SIZE, [this] (int workerId, int begin, int end) {
+		SudokuSolver* solver = m_solvers[workerId];
+
+		for (int i=begin; i<end; i++) {
+			BatchEntry* entry = &m_entries[i];
+
+			entry->m_solved = solvePuzzle(solver, entry);
+
+			m_propagationStats[workerId].add(*solver->getPropagationStats());
+			m_solverStats[workerId].add(*solver->getSolverStats());
+		}
+	});
+}
+
+// "-" reads from stdin
+int BatchSolver::solveFile (const char* filename, FILE* output) {
+	FILE* fp = openPuzzleFile(filename);
+	if (!fp) {
+		return -1;
+	}
+
+	solveStream(fp, output);
+
+	closePuzzleFile(fp);
+
+	return 0;
+}
+
+void BatchSolver::solveStream (FILE* fp, FILE* output) {
+	double startTime = getTimeInSeconds();
+
+	PuzzleReader reader(fp);
+	reader.readBlocks(m_entries, BATCH_BLOCK_SIZE, [this, output] (int numEntries) {
+		solveBlock(numEntries);
+
+		for (int i=0; i<numEntries; i++) {
+			BatchEntry* entry = &m_entries[i];
+
+			if (entry->m_solved) {
+				m_numSolved++;
+			}
+
+			if (!output) {
+				continue;
+			}
+
+			if (entry->m_solved) {
+				fprintf(output, "%s\n", entry->m_solution);
+			} else {
+				fprintf(output, "%s no solution\n", entry->m_puzzle);
+			}
+		}
+
+		m_numPuzzles += numEntries;
+	});
+
+	m_elapsedTime += getTimeInSeconds() - startTime;
+}
+
+void BatchSolver::printSummary (FILE* fp) {
+	double puzzlesPerSecond = (m_elapsedTime > 0) ? (m_numPuzzles / m_elapsedTime) : 0;
+
+	fprintf(fp, "%d puzzles: %d solved, %d no solution in %.3f seconds (%.1f puzzles/sec, %d threads)\n",
+		m_numPuzzles, m_numSolved, m_numPuzzles - m_numSolved, m_elapsedTime, puzzlesPerSecond,
+		m_scheduler.getNumThreads());
+
+	PropagationStats propagationStats;
+	for (int i=0; i<m_propagationStats.size(); i++) {
+		propagationStats.add(m_propagationStats[i]);
+	}
+
+	fprintf(fp, "propagation: %d steps, %d cell checks, %d unit scans, %d unit scans avoided\n",
+		propagationStats.m_numSteps, propagationStats.m_numCellChecks,
+		propagationStats.m_numUnitScans, propagationStats.m_numUnitScansAvoided);
+	fprintf(fp, "dirty tracking: %d clean units skipped, %d clean values skipped\n",
+		propagationStats.m_numCleanUnitsSkipped, propagationStats.m_numCleanDigitsSkipped);
+}
+
+void BatchSolver::getSolverStats (SolverStats* solverStats) {
+	solverStats->reset();
+
+	for (int i=0; i<m_solverStats.size(); i++) {
+		solverStats->add(m_solverStats[i]);
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdio.h>
+
+#include <functional>
+#include <vector>
+
+#include "sudoku.h"
+#include "Scheduler.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define PUZZLE_STRING_LENGTH				(g_N * g_N)
+
+// Reads puzzles from a stream, one per line: cells are '1'..'9' for givens
+// and '-', '.' or '0' for blanks, everything else is window dressing.
+// Lines starting with '#' are comments, and blank lines are skipped.
+class PuzzleReader {
+	public:
+										PuzzleReader (FILE* fp) { m_fp = fp; m_lineNumber = 0; }
+
+		// Fill puzzle[] with the cells of the next line that has PUZZLE_STRING_LENGTH of them (plus a NUL).
+		// Any other line with cells on it is reported and skipped.
+		// return false when the stream is exhausted
+		bool							getNextPuzzle (char puzzle[PUZZLE_STRING_LENGTH+1]);
+
+		// Read the whole stream, up to blockSize puzzles at a time, into the m_puzzle of each of entries[],
+		// and call processBlock() with the number of them after each block
+		template <class Entry>
+		void							readBlocks (std::vector<Entry>& entries, int blockSize,
+											std::function<void (int numEntries)> processBlock) {
+											entries.resize(blockSize);
+
+											bool moreInput = true;
+											while (moreInput) {
+												int numEntries = 0;
+												while ((numEntries < blockSize) && (moreInput = getNextPuzzle(entries[numEntries].m_puzzle))) {
+													numEntries++;
+												}
+
+												processBlock(numEntries);
+											}
+										}
+
+	protected:
+		int								readLine (char cells[PUZZLE_STRING_LENGTH]);
+
+		FILE*							m_fp;
+		int								m_lineNumber;
+};
+
+// Open a corpus for reading ("-" for stdin).
+// return NULL (with an error message) if the file can't be opened
+extern FILE* openPuzzleFile (const char* filename);
+extern void closePuzzleFile (FILE* fp);
+
+////////////////////////////////////////////////////////////////////////////////
+
+// One puzzle (and its solution) in a batch
+struct BatchEntry {
+	char							m_puzzle[PUZZLE_STRING_LENGTH+1];
+	char							m_solution[PUZZLE_STRING_LENGTH+1];
+	bool							m_solved;
+};
+
+// Solves a corpus of puzzles. Each worker thread has its own SudokuSolver,
+// the input is read in blocks, and the solutions are written in input order.
+class BatchSolver {
+	public:
+										BatchSolver (int numThreads=1);
+										~BatchSolver ();
+
+		// Write each puzzle's solution (or "<puzzle> no solution") to "output" (if it's not NULL), in input order
+		// ("-" reads from stdin)
+		int								solveFile (const char* filename, FILE* output);
+		void							solveStream (FILE* fp, FILE* output);
+		bool							solvePuzzle (SudokuSolver* solver, BatchEntry* entry);
+
+		void							setSolveMethod (SolveMethodType solveMethod);
+		void							setUseChains (bool useChains);
+
+		void							printSummary (FILE* fp);
+
+		// Per-algorithm counters, added up over all of the workers
+		void							getSolverStats (SolverStats* solverStats);
+
+		int								getNumPuzzles () { return m_numPuzzles; }
+		int								getNumSolved () { return m_numSolved; }
+
+	protected:
+		void							solveBlock (int numEntries);
+
+		WorkStealingScheduler			m_scheduler;
+		std::vector<SudokuSolver*>		m_solvers; // one per worker
+		std::vector<PropagationStats>	m_propagationStats; // one per worker
+		std::vector<SolverStats>		m_solverStats; // one per worker
+		std::vector<BatchEntry>			m_entries;
+
+		int								m_numPuzzles;
+		int								m_numSolved;
+		double							m_elapsedTime;
+};
@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "Common.h"
+
+#include "BoardSolver.h"
+#include "Scheduler.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const char* g_valueSymbols = "123456789ABCDEFGHIJKLMNOP";
+
+// When counting every solution, split the search into this many pieces per thread
+// (enough that the work stealing can even out the big pieces and the small ones)
+#define SPLIT_GRIDS_PER_THREAD				64
+
+// return the value (0..24) for a symbol, -1 for a blank, or -2 for anything else
+static int symbolToValue (char c) {
+	if ((c == '.') || (c == '-') || (c == '0')) {
+		return -1;
+	}
+
+	const char* symbol = strchr(g_valueSymbols, toupper(c));
+
+	return (symbol && (c != '\0')) ? (symbol - g_valueSymbols) : -2;
+}
+
+int parsePuzzleString (const char* puzzle, int grid[MAX_NUM_CELLS]) {
+	int numCells = 0;
+
+	for (const char* c=puzzle; *c; c++) {
+		int value = symbolToValue(*c);
+
+		if ((value >= -1) && (numCells < MAX_NUM_CELLS)) {
+			grid[numCells++] = value;
+		}
+	}
+
+	for (int n=MIN_BOX_SIZE; n<=MAX_BOX_SIZE; n++) {
+		int N = n * n;
+
+		if (numCells != (N * N)) {
+			continue;
+		}
+
+		// make sure every value fits on this board
+		for (int i=0; i<numCells; i++) {
+			if (grid[i] >= N) {
+				TRACE(0, "Error: '%c' isn't a value on a %dx%d board\n", g_valueSymbols[grid[i]], N, N);
+				return -1;
+			}
+		}
+
+		return n;
+	}
+
+	TRACE(0, "Error: %d cells isn't a 4x4, 9x9, 16x16 or 25x25 board\n", numCells);
+
+	return -1;
+}
+
+template <int n>
+static int countGridSolutions (const int grid[], char solution[], int limit) {
+	static const int NUM_CELLS = BoardSolver<n>::NUM_CELLS;
+
+	// n.b., the 25x25 solver is too big to put on the stack
+	BoardSolver<n>* solver = new BoardSolver<n>();
+	int values[NUM_CELLS];
+
+	int numSolutions = solver->countSolutions(grid, values, limit);
+	delete solver;
+
+	for (int i=0; i<NUM_CELLS; i++) {
+		solution[i] = (numSolutions > 0) ? g_valueSymbols[values[i]] : ((grid[i] >= 0) ? g_valueSymbols[grid[i]] : '.');
+	}
+	solution[NUM_CELLS] = '\0';
+
+	return numSolutions;
+}
+
+int solvePuzzleString (const char* puzzle, char solution[MAX_NUM_CELLS+1], int limit) {
+	int grid[MAX_NUM_CELLS];
+
+	switch (parsePuzzleString(puzzle, grid)) {
+		case 2:
+			return countGridSolutions<2>(grid, solution, limit);
+
+		case 3:
+			return countGridSolutions<3>(grid, solution, limit);
+
+		case 4:
+			return countGridSolutions<4>(grid, solution, limit);
+
+		case 5:
+			return countGridSolutions<5>(grid, solution, limit);
+
+		default:
+			break;
+	}
+
+	solution[0] = '\0';
+
+	return -1;
+}
+
+template <int n>
+static uint64_t countAllGridSolutions (const int grid[], int numThreads) {
+	static const int NUM_CELLS = BoardSolver<n>::NUM_CELLS;
+
+	WorkStealingScheduler scheduler(numThreads);
+
+	std::vector<BoardSolver<n>*> solvers;
+	std::vector<uint64_t> numSolutions;
+	for (int i=0; i<scheduler.getNumThreads(); i++) {
+		solvers.push_back(new BoardSolver<n>());
+		numSolutions.push_back(0);
+	}
+
+	std::vector<int> grids;
+	solvers[0]->splitSearch(grid, scheduler.getNumThreads() * SPLIT_GRIDS_PER_THREAD, &grids, &numSolutions[0]);
+
+	int numGrids = grids.size() / NUM_CELLS;
+	TRACE(1, "%s() %d pieces, %d threads\n", __CLASSFUNCTION__, numGrids, scheduler.getNumThreads());
+
+	scheduler.run(numGrids, 1, [&] (int workerId, int begin, int end) {
+		for (int i=begin; i<end; i++) {
+			numSolutions[workerId] += solvers[workerId]->countSolutions(&grids[i * NUM_CELLS], NULL, NO_SOLUTION_LIMIT);
+		}
+	});
+
+	uint64_t totalSolutions = 0;
+	for (int i=0; i<solvers.size(); i++) {
+		totalSolutions += numSolutions[i];
+		delete solvers[i];
+	}
+
+	return totalSolutions;
+}
+
+template <int n>
+static uint64_t countGridSolutionsUpTo (const int grid[], uint64_t limit, int numThreads) {
+	if (limit == NO_SOLUTION_LIMIT) {
+		return countAllGridSolutions<n>(grid, numThreads);
+	}
+
+	// n.b., the 25x25 solver is too big to put on the stack
+	BoardSolver<n>* solver = new BoardSolver<n>();
+	uint64_t numSolutions = solver->countSolutions(grid, NULL, limit);
+	delete solver;
+
+	return numSolutions;
+}
+
+int64_t countPuzzleSolutions (const char* puzzle, uint64_t limit, int numThreads) {
+	int grid[MAX_NUM_CELLS];
+
+	switch (parsePuzzleString(puzzle, grid)) {
+		case 2:
+			return countGridSolutionsUpTo<2>(grid, limit, numThreads);
+
+		case 3:
+			return countGridSolutionsUpTo<3>(grid, limit, numThreads);
+
+		case 4:
+			return countGridSolutionsUpTo<4>(grid, limit, numThreads);
+
+		case 5:
+			return countGridSolutionsUpTo<5>(grid, limit, numThreads);
+
+		default:
+			break;
+	}
+
+	return -1;
+}
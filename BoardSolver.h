@@ -0,0 +1,375 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+#include <vector>
+
+#include "Topology.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A small, fast solver for any board size (n x n boxes, N = n*n values), all bitmasks:
+// naked and hidden singles to propagate, then a depth first search on the cell with the
+// fewest candidates. Everything that depends on the size (the mask width, the topology)
+// is fixed at compile time, so each instantiation is as tight as a hand written one.
+//
+// n.b., this is the engine for boards other than 9x9 (and for counting solutions);
+// the logical algorithms in SudokuSolver are 9x9 only.
+template <int n>
+class BoardSolver {
+	public:
+		typedef Topology<n>				BoardShape;
+
+		static constexpr int			N = BoardShape::N;
+		static constexpr int			NUM_CELLS = BoardShape::NUM_CELLS;
+
+		// bit "v" is set if value "v" (0..N-1) is possible
+		typedef typename std::conditional<(N <= 16), uint16_t, uint32_t>::type Mask;
+
+		static constexpr Mask			ALL_VALUES = (Mask)(((uint64_t)1 << N) - 1);
+
+										BoardSolver () { m_numSearchNodes = 0; }
+
+		// grid[] has a value (0..N-1) or -1 for each cell, row by row.
+		// Stop after "limit" solutions (NO_SOLUTION_LIMIT to count them all). The first solution found is
+		// left in solution[] (if not NULL).
+		// return the number of solutions found (0 if the givens contradict each other)
+		uint64_t						countSolutions (const int grid[NUM_CELLS], int solution[NUM_CELLS], uint64_t limit=1) {
+											return countFromHere(setGivens(grid, -1, 0), solution, limit);
+										}
+
+		// Is there a solution to grid[] without "value" in "cell"?
+		// For a puzzle with a known solution, that's the same as asking whether it has more than one solution
+		// once the clue in that cell is taken away, but it's much faster to answer: ruling the old value out
+		// usually leads straight to a contradiction.
+		bool							hasSolutionWithout (const int grid[NUM_CELLS], int cell, int value) {
+											return (countFromHere(setGivens(grid, cell, bit(value)), NULL, 1) > 0);
+										}
+
+		// The same as countSolutions() and hasSolutionWithout(), but starting from each cell's possible values
+		// (e.g., whatever a SudokuSolver has worked out so far) instead of just the givens
+		uint64_t						countSolutionsFrom (const Mask candidates[NUM_CELLS], int solution[NUM_CELLS], uint64_t limit=1) {
+											return countFromHere(setCandidates(candidates, -1, 0), solution, limit);
+										}
+
+		bool							hasSolutionWithoutFrom (const Mask candidates[NUM_CELLS], int cell, int value) {
+											return (countFromHere(setCandidates(candidates, cell, bit(value)), NULL, 1) > 0);
+										}
+
+		// Split the search for grid[]'s solutions into at least minGrids pieces (if it's big enough), to be
+		// counted separately: the guesses are made breadth first, and each piece is grid[] plus one set of
+		// guesses (and whatever they forced). Every solution of grid[] is a solution of exactly one piece.
+		// The pieces are appended to grids[] (NUM_CELLS values each), and the solutions that turned up
+		// along the way are added to *numSolutions.
+		void							splitSearch (const int grid[NUM_CELLS], int minGrids, std::vector<int>* grids, uint64_t* numSolutions) {
+											std::vector<int> queue(grid, grid + NUM_CELLS);
+											int next = 0;
+
+											while ((next < queue.size()) && (((queue.size() - next) / NUM_CELLS) < minGrids)) {
+												int piece[NUM_CELLS];
+												memcpy(piece, &queue[next], sizeof(piece));
+												next += NUM_CELLS;
+
+												if (!setGivens(piece, -1, 0)) {
+													continue;
+												}
+
+												int bestCell = findBestCell();
+												if (bestCell < 0) {
+													(*numSolutions)++;
+													continue;
+												}
+
+												// n.b., keep what propagation found, so it doesn't have to be found again
+												for (int cell=0; cell<NUM_CELLS; cell++) {
+													if (count(m_candidates[cell]) == 1) {
+														piece[cell] = first(m_candidates[cell]);
+													}
+												}
+
+												Mask values = m_candidates[bestCell];
+												while (values) {
+													piece[bestCell] = first(values);
+													values &= values - 1;
+
+													queue.insert(queue.end(), piece, piece + NUM_CELLS);
+												}
+											}
+
+											grids->insert(grids->end(), queue.begin() + next, queue.end());
+										}
+
+		int								getNumSearchNodes () { return m_numSearchNodes; }
+
+	protected:
+		static constexpr BoardShape		s_shape = BoardShape();
+
+		static Mask						bit (int value) { return (Mask)1 << value; }
+		static int						count (Mask mask) { return __builtin_popcount(mask); }
+		static int						first (Mask mask) { return __builtin_ctz(mask); }
+
+		// Start over with grid[]'s givens (and "excludedValues" ruled out in "excludedCell", if it's >= 0).
+		// n.b., rather than removing each given from its peers one at a time, the values given in each
+		// row/col/box are collected first, and each blank cell starts out with whatever its units are missing.
+		// Only the blank cells that are down to one value go on the queue.
+		// return false if the givens contradict each other
+		bool							setGivens (const int grid[NUM_CELLS], int excludedCell, Mask excludedValues) {
+											Mask givenValues[BoardShape::NUM_UNITS];
+											memset(givenValues, 0, sizeof(givenValues));
+
+											for (int cell=0; cell<NUM_CELLS; cell++) {
+												if (grid[cell] >= 0) {
+													Mask value = bit(grid[cell]);
+
+													for (int i=0; i<3; i++) {
+														int unit = s_shape.m_cellUnits[cell][i];
+														if (givenValues[unit] & value) {
+															return false; // a peer has the same value
+														}
+														givenValues[unit] |= value;
+													}
+												}
+											}
+
+											m_queueLength = 0;
+
+											for (int cell=0; cell<NUM_CELLS; cell++) {
+												if (grid[cell] >= 0) {
+													m_candidates[cell] = bit(grid[cell]);
+													continue;
+												}
+
+												const typename BoardShape::CellIndex* units = s_shape.m_cellUnits[cell];
+												m_candidates[cell] = ALL_VALUES;
+
+												if (!eliminate(cell, givenValues[units[0]] | givenValues[units[1]] | givenValues[units[2]])) {
+													return false;
+												}
+											}
+
+											if ((excludedCell >= 0) && !eliminate(excludedCell, excludedValues)) {
+												return false;
+											}
+
+											return propagate();
+										}
+
+		// The same as setGivens(), from each cell's possible values.
+		// n.b., any cell that's down to one value might not have been removed from its peers yet, so they're all queued
+		bool							setCandidates (const Mask candidates[NUM_CELLS], int excludedCell, Mask excludedValues) {
+											m_queueLength = 0;
+
+											for (int cell=0; cell<NUM_CELLS; cell++) {
+												m_candidates[cell] = candidates[cell];
+
+												if (m_candidates[cell] == 0) {
+													return false;
+												}
+
+												if (count(m_candidates[cell]) == 1) {
+													m_queue[m_queueLength++] = cell;
+												}
+											}
+
+											if ((excludedCell >= 0) && !eliminate(excludedCell, excludedValues)) {
+												return false;
+											}
+
+											return propagate();
+										}
+
+		// Search from wherever setGivens()/setCandidates() left things ("consistent" is what they returned)
+		uint64_t						countFromHere (bool consistent, int solution[NUM_CELLS], uint64_t limit) {
+											m_solution = solution;
+											m_limit = limit;
+											m_numSolutions = 0;
+											m_numSearchNodes = 0;
+
+											if (consistent) {
+												search();
+											}
+
+											return m_numSolutions;
+										}
+
+		// Remove "values" from a cell. A cell that gets down to one candidate is queued
+		// so its value can be removed from its peers.
+		// return false if the cell has nothing left
+		bool							eliminate (int cell, Mask values) {
+											Mask candidates = m_candidates[cell];
+											if (!(candidates & values)) {
+												return true;
+											}
+
+											candidates &= ~values;
+											m_candidates[cell] = candidates;
+
+											if (candidates == 0) {
+												return false;
+											}
+
+											if (count(candidates) == 1) {
+												m_queue[m_queueLength++] = cell;
+											}
+
+											return true;
+										}
+
+		// Naked singles (the queue), then hidden singles (a pass over every unit), until nothing changes.
+		// return false on a contradiction
+		bool							propagate () {
+											while (true) {
+												while (m_queueLength > 0) {
+													int cell = m_queue[--m_queueLength];
+													Mask value = m_candidates[cell];
+
+													const typename BoardShape::CellIndex* peers = s_shape.m_peers[cell];
+													for (int i=0; i<BoardShape::NUM_PEERS; i++) {
+														if (!eliminate(peers[i], value)) {
+															return false;
+														}
+													}
+												}
+
+												bool anyPlaced = false;
+
+												for (int unit=0; unit<BoardShape::NUM_UNITS; unit++) {
+													const typename BoardShape::CellIndex* cells = s_shape.m_unitCells[unit];
+
+													// Which values are possible at least once, more than once, and already placed
+													Mask once = 0;
+													Mask twice = 0;
+													Mask placed = 0;
+													for (int i=0; i<N; i++) {
+														Mask candidates = m_candidates[cells[i]];
+
+														twice |= once & candidates;
+														once |= candidates;
+														if (count(candidates) == 1) {
+															placed |= candidates;
+														}
+													}
+
+													if (once != ALL_VALUES) {
+														return false; // some value has nowhere to go
+													}
+
+													Mask hiddenSingles = once & ~twice & ~placed;
+													while (hiddenSingles) {
+														Mask value = hiddenSingles & -hiddenSingles;
+														hiddenSingles &= hiddenSingles - 1;
+
+														for (int i=0; i<N; i++) {
+															if (m_candidates[cells[i]] & value) {
+																m_candidates[cells[i]] = value;
+																m_queue[m_queueLength++] = cells[i];
+																break;
+															}
+														}
+
+														anyPlaced = true;
+													}
+												}
+
+												if (!anyPlaced) {
+													return true;
+												}
+											}
+										}
+
+		// The (first) cell with the fewest candidates, or -1 if every cell has just one
+		int								findBestCell () {
+											int bestCell = -1;
+											int bestCount = N + 1;
+											for (int cell=0; cell<NUM_CELLS; cell++) {
+												int numCandidates = count(m_candidates[cell]);
+
+												if ((numCandidates > 1) && (numCandidates < bestCount)) {
+													bestCell = cell;
+													bestCount = numCandidates;
+
+													if (numCandidates == 2) {
+														break;
+													}
+												}
+											}
+
+											return bestCell;
+										}
+
+		// Guess each value for the cell with the fewest candidates, propagate, and recurse.
+		// n.b., m_candidates is saved on the stack for each guess
+		void							search () {
+											m_numSearchNodes++;
+
+											int bestCell = findBestCell();
+											if (bestCell < 0) {
+												// solved!
+												if ((m_numSolutions++ == 0) && m_solution) {
+													for (int cell=0; cell<NUM_CELLS; cell++) {
+														m_solution[cell] = first(m_candidates[cell]);
+													}
+												}
+
+												return;
+											}
+
+											Mask savedCandidates[NUM_CELLS];
+											memcpy(savedCandidates, m_candidates, sizeof(m_candidates));
+
+											Mask values = m_candidates[bestCell];
+											while (values && (m_numSolutions < m_limit)) {
+												Mask value = values & -values;
+												values &= values - 1;
+
+												m_candidates[bestCell] = value;
+												m_queue[0] = bestCell;
+												m_queueLength = 1;
+
+												if (propagate()) {
+													search();
+												}
+
+												memcpy(m_candidates, savedCandidates, sizeof(m_candidates));
+											}
+										}
+
+		Mask							m_candidates[NUM_CELLS];
+
+		// Cells that are down to one candidate, which hasn't been removed from their peers yet
+		int								m_queue[NUM_CELLS];
+		int								m_queueLength;
+
+		int*							m_solution;
+		uint64_t						m_numSolutions;
+		uint64_t						m_limit;
+		int								m_numSearchNodes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Puzzle strings for any board size: '1'..'9' then 'A'..'P' (either case) for the values,
+// '.', '-' or '0' for blanks; anything else is ignored.
+// The box size is picked from the number of cells: 16 (4x4), 81 (9x9), 256 (16x16) or 625 (25x25)
+#define MIN_BOX_SIZE						2
+#define MAX_BOX_SIZE						5
+#define MAX_NUM_CELLS						(MAX_BOX_SIZE * MAX_BOX_SIZE * MAX_BOX_SIZE * MAX_BOX_SIZE)
+
+// Count every solution
+#define NO_SOLUTION_LIMIT					UINT64_MAX
+
+// Translate puzzle text into grid[] (a value 0..N-1 or -1 for each cell).
+// return the box size (n), or -1 if the number of cells isn't one of the supported sizes
+extern int parsePuzzleString (const char* puzzle, int grid[MAX_NUM_CELLS]);
+
+// Solve a puzzle of any supported size with the matching BoardSolver, and write the first solution
+// into solution[] as text (NUL terminated). Stop counting after "limit" solutions.
+// return the number of solutions found, or -1 if the puzzle isn't a supported size
+extern int solvePuzzleString (const char* puzzle, char solution[MAX_NUM_CELLS+1], int limit=1);
+
+// Count a puzzle's solutions (any supported size), stopping at "limit". With NO_SOLUTION_LIMIT, the search
+// is split up and the pieces are counted on numThreads threads.
+// return the number of solutions, or -1 if the puzzle isn't a supported size
+extern int64_t countPuzzleSolutions (const char* puzzle, uint64_t limit, int numThreads=1);
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Every subset of N things (as a bitmask), grouped by size and computed at compile time.
+// The subsets of size k are m_masks[m_first[k]] .. m_masks[m_first[k+1]-1], in increasing order.
+//
+// Picking the k-subsets of some smaller set (e.g., the cells in a row that are still open)
+// is then just a walk over the size k entries, skipping the ones that aren't inside it:
+// no Permutator, no index arithmetic and nothing allocated.
+template <int N>
+struct CombinationTable {
+	static constexpr int				NUM_MASKS = 1 << N;
+
+	uint16_t							m_masks[NUM_MASKS];
+	int									m_first[N + 2];
+
+	constexpr							CombinationTable () : m_masks(), m_first() {
+											int numMasks = 0;
+
+											for (int k=0; k<=N; k++) {
+												m_first[k] = numMasks;
+
+												for (int mask=0; mask<NUM_MASKS; mask++) {
+													if (__builtin_popcount(mask) == k) {
+														m_masks[numMasks++] = mask;
+													}
+												}
+											}
+
+											m_first[N + 1] = numMasks;
+										}
+};
+
+// Visit each subset of "mask" with exactly k members (varName is the subset, as an int mask)
+#define ForEachSubsetOfSize(table, mask, k, varName)							\
+	for (int varName ## _i=(table).m_first[k], varName=0; varName ## _i<(table).m_first[(k)+1]; varName ## _i++)	\
+		if (((varName=(table).m_masks[varName ## _i]) & ~(mask)) != 0) { } else
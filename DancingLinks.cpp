@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Common.h"
+
+#include "DancingLinks.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+#define DLX_ROOT							0
+
+DancingLinks::DancingLinks () {
+	// The column headers form a circular list with the root
+	for (int column=0; column<=DLX_NUM_COLUMNS; column++) {
+		m_left[column] = (column == 0) ? DLX_NUM_COLUMNS : column - 1;
+		m_right[column] = (column == DLX_NUM_COLUMNS) ? 0 : column + 1;
+		m_up[column] = column;
+		m_down[column] = column;
+		m_column[column] = column;
+		m_rowId[column] = -1;
+		m_size[column] = 0;
+	}
+
+	int node = DLX_NUM_COLUMNS + 1;
+	for (int row=0; row<g_N; row++) {
+		for (int col=0; col<g_N; col++) {
+			for (int value=0; value<g_N; value++) {
+				int rowId = (((row * g_N) + col) * g_N) + value;
+				int firstNode = node;
+
+				m_rowNodes[rowId] = firstNode;
+
+				for (int constraintType=0; constraintType<4; constraintType++, node++) {
+					int column = getColumnForConstraint(constraintType, row, col, value);
+
+					// Add to the bottom of the column
+					m_column[node] = column;
+					m_rowId[node] = rowId;
+					m_up[node] = m_up[column];
+					m_down[node] = column;
+					m_down[m_up[column]] = node;
+					m_up[column] = node;
+					m_size[column]++;
+
+					// Add to the end of the row
+					m_left[node] = (constraintType == 0) ? node : node - 1;
+					m_right[node] = firstNode;
+					m_right[m_left[node]] = node;
+					m_left[firstNode] = node;
+				}
+			}
+		}
+	}
+}
+
+// The constraint types are in the same order as the collections:
+// the cell itself, then ROW_COLLECTION, COL_COLLECTION, BOX_COLLECTION
+int DancingLinks::getColumnForConstraint (int constraintType, int row, int col, int value) {
+	int box = ((row / g_n) * g_n) + (col / g_n);
+
+	int index =
+		(constraintType == 0) ? (row * g_N) + col :
+		(constraintType == 1) ? (row * g_N) + value :
+		(constraintType == 2) ? (col * g_N) + value :
+		(box * g_N) + value;
+
+	return 1 + (constraintType * g_N * g_N) + index;
+}
+
+void DancingLinks::cover (int column) {
+	m_right[m_left[column]] = m_right[column];
+	m_left[m_right[column]] = m_left[column];
+
+	for (int i=m_down[column]; i!=column; i=m_down[i]) {
+		for (int j=m_right[i]; j!=i; j=m_right[j]) {
+			m_down[m_up[j]] = m_down[j];
+			m_up[m_down[j]] = m_up[j];
+			m_size[m_column[j]]--;
+		}
+	}
+}
+
+void DancingLinks::uncover (int column) {
+	for (int i=m_up[column]; i!=column; i=m_up[i]) {
+		for (int j=m_left[i]; j!=i; j=m_left[j]) {
+			m_size[m_column[j]]++;
+			m_down[m_up[j]] = j;
+			m_up[m_down[j]] = j;
+		}
+	}
+
+	m_right[m_left[column]] = column;
+	m_left[m_right[column]] = column;
+}
+
+// Choose a row up front (i.e., a given).
+// return false if one of its columns is already satisfied (the givens conflict)
+bool DancingLinks::selectRow (int node) {
+	int i = node;
+	do {
+		int column = m_column[i];
+		if (m_right[m_left[column]] != column) {
+			// Undo the columns we've already covered for this row
+			for (int j=m_left[i]; j!=m_left[node]; j=m_left[j]) {
+				uncover(m_column[j]);
+			}
+			return false;
+		}
+
+		cover(column);
+		i = m_right[i];
+	} while (i != node);
+
+	return true;
+}
+
+void DancingLinks::unselectRow (int node) {
+	int i = m_left[node];
+	do {
+		uncover(m_column[i]);
+		i = m_left[i];
+	} while (i != m_left[node]);
+}
+
+void DancingLinks::search () {
+	if (m_right[DLX_ROOT] == DLX_ROOT) {
+		// Every constraint is satisfied
+		if (m_numSolutions++ == 0) {
+			memcpy(m_solution, m_partial, sizeof(m_partial));
+		}
+		return;
+	}
+
+	// Choose the column with the fewest rows
+	int column = m_right[DLX_ROOT];
+	for (int i=m_right[column]; i!=DLX_ROOT; i=m_right[i]) {
+		if (m_size[i] < m_size[column]) {
+			column = i;
+
+			if (m_size[column] <= 1) {
+				break;
+			}
+		}
+	}
+
+	if (m_size[column] == 0) {
+		return;
+	}
+
+	cover(column);
+
+	for (int i=m_down[column]; (i!=column) && (m_numSolutions<m_limit); i=m_down[i]) {
+		int rowId = m_rowId[i];
+		int cell = rowId / g_N;
+		m_partial[cell] = rowId % g_N;
+
+		for (int j=m_right[i]; j!=i; j=m_right[j]) {
+			cover(m_column[j]);
+		}
+
+		search();
+
+		for (int j=m_left[i]; j!=i; j=m_left[j]) {
+			uncover(m_column[j]);
+		}
+	}
+
+	uncover(column);
+}
+
+int DancingLinks::solve (const int grid[g_N * g_N], int solution[g_N * g_N], int limit) {
+	int selectedRows[g_N * g_N];
+	int numSelected = 0;
+	bool consistent = true;
+
+	for (int cell=0; cell<g_N*g_N; cell++) {
+		m_partial[cell] = grid[cell];
+
+		if (grid[cell] < 0) {
+			continue;
+		}
+
+		int node = m_rowNodes[(cell * g_N) + grid[cell]];
+		if (!selectRow(node)) {
+			consistent = false;
+			break;
+		}
+
+		selectedRows[numSelected++] = node;
+	}
+
+	m_solution = solution;
+	m_numSolutions = 0;
+	m_limit = limit;
+
+	if (consistent) {
+		search();
+	}
+
+	// Put the matrix back the way we found it
+	while (numSelected > 0) {
+		unselectRow(selectedRows[--numSelected]);
+	}
+
+	TRACE(3, "%s() %d solutions\n", __CLASSFUNCTION__, m_numSolutions);
+
+	return m_numSolutions;
+}
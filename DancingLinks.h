@@ -0,0 +1,57 @@
+#pragma once
+
+#include "sudoku.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Knuth's Algorithm X with dancing links, on the exact cover version of sudoku.
+//
+// There are 324 constraints (columns), 81 of each kind:
+// 1) each cell has a value,
+// 2) each row has each value,
+// 3) each col has each value,
+// 4) each box has each value.
+// Placing value v in cell (row, col) is a matrix row that satisfies exactly one of each.
+//
+// All of the nodes are allocated up front; solving a puzzle only relinks them.
+#define DLX_NUM_COLUMNS						(4 * g_N * g_N)
+#define DLX_NUM_ROWS						(g_N * g_N * g_N)
+#define DLX_NUM_NODES						(1 + DLX_NUM_COLUMNS + (4 * DLX_NUM_ROWS))
+
+class DancingLinks {
+	public:
+										DancingLinks ();
+
+		// grid[] has a value (0..g_N-1) or -1 for each cell, row by row.
+		// Stop after "limit" solutions. The first solution found is left in solution[].
+		// return the number of solutions found (0 if the givens contradict each other)
+		int								solve (const int grid[g_N * g_N], int solution[g_N * g_N], int limit=1);
+
+	protected:
+		void							cover (int column);
+		void							uncover (int column);
+		bool							selectRow (int node);
+		void							unselectRow (int node);
+		void							search ();
+
+		int								getColumnForConstraint (int constraintType, int row, int col, int value);
+
+		// Node links. Node 0 is the root, 1..DLX_NUM_COLUMNS are the column headers
+		int								m_left[DLX_NUM_NODES];
+		int								m_right[DLX_NUM_NODES];
+		int								m_up[DLX_NUM_NODES];
+		int								m_down[DLX_NUM_NODES];
+		int								m_column[DLX_NUM_NODES];
+		int								m_rowId[DLX_NUM_NODES]; // (cell * g_N) + value
+
+		int								m_size[1 + DLX_NUM_COLUMNS];
+
+		// The first node of each matrix row
+		int								m_rowNodes[DLX_NUM_ROWS];
+
+		// Search state
+		int								m_partial[g_N * g_N];
+		int*							m_solution;
+		int								m_numSolutions;
+		int								m_limit;
+};
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Common.h"
+
+#include "DifficultyRater.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Puzzles are read, rated and written this many at a time
+#define RATING_BLOCK_SIZE					65536
+
+// Puzzles per unit of work handed out by the scheduler
+#define RATING_CHUNK_SIZE					16
+
+static const char* s_statusNames[NUM_RATING_STATUSES] = {
+	"no solution",
+	"not unique",
+	"rated",
+};
+
+const char* ratingStatusToString (RatingStatus status) {
+	return s_statusNames[status];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DifficultyRater::DifficultyRater (int numThreads) : m_scheduler(numThreads) {
+	for (int i=0; i<m_scheduler.getNumThreads(); i++) {
+		m_solvers.push_back(new SudokuSolver());
+		m_boardSolvers.push_back(new BoardSolver<g_n>());
+	}
+
+	m_solverStats.resize(m_solvers.size());
+
+	memset(m_histogram, 0, sizeof(m_histogram));
+	m_numPuzzles = 0;
+	memset(m_numWithStatus, 0, sizeof(m_numWithStatus));
+	m_elapsedTime = 0;
+}
+
+DifficultyRater::~DifficultyRater () {
+	for (int i=0; i<m_solvers.size(); i++) {
+		delete m_boardSolvers[i];
+		delete m_solvers[i];
+	}
+}
+
+void DifficultyRater::rateBlock (int numEntries) {
+	m_scheduler.run(numEntries, RATING_CHUNK_SIZE, [this] (int workerId, int begin, int end) {
+		SudokuSolver* solver = m_solvers[workerId];
+		BoardSolver<g_n>* boardSolver = m_boardSolvers[workerId];
+
+		for (int i=begin; i<end; i++) {
+			RatingEntry* entry = &m_entries[i];
+
+			// Only a puzzle with exactly one solution can be rated
+			int grid[g_N * g_N];
+			for (int cell=0; cell<g_N*g_N; cell++) {
+				grid[cell] = (entry->m_puzzle[cell] == '-') ? -1 : (entry->m_puzzle[cell] - '1');
+			}
+
+			uint64_t numSolutions = boardSolver->countSolutions(grid, NULL, 2);
+			entry->m_status = (numSolutions == 0) ? RATING_NO_SOLUTION :
+				(numSolutions == 1) ? RATING_RATED : RATING_NOT_UNIQUE;
+
+			if (entry->m_status != RATING_RATED) {
+				continue;
+			}
+
+			solver->loadGameString(entry->m_puzzle);
+			solver->rateDifficulty(&entry->m_rating);
+
+			m_solverStats[workerId].add(*solver->getSolverStats());
+		}
+	});
+}
+
+// e.g., {"puzzle": "...", "hardest": "X-wings", "search": false, "eliminations": 85, "placements": 52,
+//        "steps": {"naked singles": 30, "hidden singles": 22, "X-wings": 1}}
+// (only the algorithms that did something are in "steps"), or {"puzzle": "...", "status": "not unique"}
+// for a puzzle that couldn't be rated
+void DifficultyRater::printEntry (RatingEntry* entry, FILE* output) {
+	if (entry->m_status != RATING_RATED) {
+		fprintf(output, "{\"puzzle\": \"%s\", \"status\": \"%s\"}\n", entry->m_puzzle, ratingStatusToString(entry->m_status));
+		return;
+	}
+
+	DifficultyRating* rating = &entry->m_rating;
+
+	fprintf(output, "{\"puzzle\": \"%s\", \"hardest\": \"%s\", \"search\": %s, \"eliminations\": %d, \"placements\": %d, \"steps\": {",
+		entry->m_puzzle, rating->m_needsSearch ? "search" : algorithmToString(rating->m_hardestAlgorithm),
+		rating->m_needsSearch ? "true" : "false", rating->m_numEliminations, rating->m_numPlacements);
+
+	const char* separator = "";
+	for (int i=0; i<NUM_ALGORITHMS; i++) {
+		if (rating->m_numSteps[i] > 0) {
+			fprintf(output, "%s\"%s\": %d", separator, algorithmToString((AlgorithmType)i), rating->m_numSteps[i]);
+			separator = ", ";
+		}
+	}
+
+	fprintf(output, "}}\n");
+}
+
+// "-" reads from stdin
+int DifficultyRater::rateFile (const char* filename, FILE* output) {
+	FILE* fp = openPuzzleFile(filename);
+	if (!fp) {
+		return -1;
+	}
+
+	rateStream(fp, output);
+
+	closePuzzleFile(fp);
+
+	return 0;
+}
+
+void DifficultyRater::rateStream (FILE* fp, FILE* output) {
+	double startTime = getTimeInSeconds();
+
+	PuzzleReader reader(fp);
+	reader.readBlocks(m_entries, RATING_BLOCK_SIZE, [this, output] (int numEntries) {
+		rateBlock(numEntries);
+
+		for (int i=0; i<numEntries; i++) {
+			RatingEntry* entry = &m_entries[i];
+
+			if (entry->m_status == RATING_RATED) {
+				m_histogram[entry->m_rating.m_hardestAlgorithm]++;
+			}
+
+			m_numWithStatus[entry->m_status]++;
+
+			if (output) {
+				printEntry(entry, output);
+			}
+		}
+
+		m_numPuzzles += numEntries;
+	});
+
+	m_elapsedTime += getTimeInSeconds() - startTime;
+}
+
+void DifficultyRater::printSummary (FILE* fp) {
+	double puzzlesPerSecond = (m_elapsedTime > 0) ? (m_numPuzzles / m_elapsedTime) : 0;
+
+	fprintf(fp, "%d puzzles: %d rated, %d not unique, %d no solution in %.3f seconds (%.1f puzzles/sec, %d threads)\n",
+		m_numPuzzles, m_numWithStatus[RATING_RATED], m_numWithStatus[RATING_NOT_UNIQUE], m_numWithStatus[RATING_NO_SOLUTION],
+		m_elapsedTime, puzzlesPerSecond, m_scheduler.getNumThreads());
+
+	int numRated = m_numWithStatus[RATING_RATED];
+
+	fprintf(fp, "%-28s %10s %7s\n", "hardest algorithm", "puzzles", "%");
+
+	for (int i=0; i<=NUM_ALGORITHMS; i++) {
+		double percentage = (numRated > 0) ? (100.0 * m_histogram[i] / numRated) : 0.0;
+
+		fprintf(fp, "%-28s %10d %6.1f%%\n",
+			(i < NUM_ALGORITHMS) ? algorithmToString((AlgorithmType)i) : "search",
+			m_histogram[i], percentage);
+	}
+}
+
+void DifficultyRater::getSolverStats (SolverStats* solverStats) {
+	solverStats->reset();
+
+	for (int i=0; i<m_solverStats.size(); i++) {
+		solverStats->add(m_solverStats[i]);
+	}
+}
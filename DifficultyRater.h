@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "sudoku.h"
+#include "BoardSolver.h"
+#include "BatchSolver.h"
+#include "Scheduler.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef enum {
+	RATING_NO_SOLUTION,				// (including givens that contradict each other)
+	RATING_NOT_UNIQUE,				// more than one solution, so there's no one way to solve it to rate
+	RATING_RATED,
+
+	NUM_RATING_STATUSES
+} RatingStatus;
+
+extern const char* ratingStatusToString (RatingStatus);
+
+// One puzzle in a batch
+struct RatingEntry {
+	char							m_puzzle[PUZZLE_STRING_LENGTH+1];
+	RatingStatus					m_status;
+	DifficultyRating				m_rating; // only for RATING_RATED
+};
+
+// Rates the difficulty of a corpus of puzzles: each one is checked for a unique solution (with a BoardSolver),
+// then solved with the logical algorithms alone (SudokuSolver::rateDifficulty()), and the ratings are written
+// in input order, one JSON object per line.
+// Along the way, the rated puzzles are counted by the hardest algorithm they needed (the histogram).
+// Each worker thread has its own solvers, and the input is read in blocks, the same as BatchSolver.
+class DifficultyRater {
+	public:
+										DifficultyRater (int numThreads=1);
+										~DifficultyRater ();
+
+		// Write each puzzle's rating to "output" (if it's not NULL)
+		// ("-" reads from stdin)
+		int								rateFile (const char* filename, FILE* output);
+		void							rateStream (FILE* fp, FILE* output);
+
+		void							printSummary (FILE* fp);
+
+		// Per-algorithm counters, added up over all of the workers
+		void							getSolverStats (SolverStats* solverStats);
+
+		int								getNumPuzzles () { return m_numPuzzles; }
+		int								getNumWithStatus (RatingStatus status) { return m_numWithStatus[status]; }
+
+		// The number of puzzles whose hardest algorithm was "algorithm" (NUM_ALGORITHMS for the ones that needed a search)
+		int								getHistogramCount (int algorithm) { return m_histogram[algorithm]; }
+
+		// The i'th puzzle's status and rating from the last block that was rated (NULL if it wasn't rated)
+		RatingStatus					getStatus (int i) { return m_entries[i].m_status; }
+		const DifficultyRating*			getRating (int i) { return (m_entries[i].m_status == RATING_RATED) ? &m_entries[i].m_rating : NULL; }
+
+	protected:
+		void							rateBlock (int numEntries);
+		void							printEntry (RatingEntry* entry, FILE* output);
+
+		WorkStealingScheduler			m_scheduler;
+		std::vector<SudokuSolver*>		m_solvers; // one per worker
+		std::vector<BoardSolver<g_n>*>	m_boardSolvers; // one per worker, for the uniqueness checks
+		std::vector<SolverStats>		m_solverStats; // one per worker
+		std::vector<RatingEntry>		m_entries;
+
+		int								m_histogram[NUM_ALGORITHMS+1];
+		int								m_numPuzzles;
+		int								m_numWithStatus[NUM_RATING_STATUSES];
+		double							m_elapsedTime;
+};
@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Common.h"
+
+#include "Generator.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Puzzles per unit of work handed out by the scheduler
+#define GENERATE_CHUNK_SIZE					16
+
+////////////////////////////////////////////////////////////////////////////////
+
+PuzzleGenerator::PuzzleGenerator (int numThreads) : m_scheduler(numThreads) {
+	for (int i=0; i<m_scheduler.getNumThreads(); i++) {
+		m_boardSolvers.push_back(new BoardSolver<g_n>());
+		m_solvers.push_back(new SudokuSolver());
+	}
+
+	m_seed = 0;
+	m_symmetric = false;
+	m_difficulty = ANY_DIFFICULTY;
+
+	m_numPuzzles = 0;
+	m_numGenerated = 0;
+	m_numAttempts = 0;
+	m_elapsedTime = 0;
+}
+
+PuzzleGenerator::~PuzzleGenerator () {
+	for (int i=0; i<m_solvers.size(); i++) {
+		delete m_boardSolvers[i];
+		delete m_solvers[i];
+	}
+}
+
+// n.b., any way of filling in the boxes on the diagonal can be finished
+bool PuzzleGenerator::makeFullGrid (RandomNumbers* random, BoardSolver<g_n>* boardSolver, int solution[g_N*g_N]) {
+	int grid[g_N * g_N];
+	for (int cell=0; cell<g_N*g_N; cell++) {
+		grid[cell] = -1;
+	}
+
+	for (int i=0; i<g_n; i++) {
+		int box = i * (g_n + 1);
+
+		int values[g_N];
+		for (int value=0; value<g_N; value++) {
+			values[value] = value;
+		}
+		random->shuffle(values, g_N);
+
+		for (int j=0; j<g_N; j++) {
+			grid[g_topology.m_unitCells[(BOX_COLLECTION * g_N) + box][j]] = values[j];
+		}
+	}
+
+	int completed[g_N * g_N];
+	if (boardSolver->countSolutions(grid, completed) != 1) {
+		return false;
+	}
+
+	// The solver always fills in the rest the same way (the lowest value first), so scramble the whole grid
+	// with the changes that keep it valid: relabel the values, shuffle the bands and the rows within
+	// each band (and the same for the columns), and maybe transpose it
+	int values[g_N];
+	for (int value=0; value<g_N; value++) {
+		values[value] = value;
+	}
+	random->shuffle(values, g_N);
+
+	int rows[g_N];
+	int cols[g_N];
+	shuffleLines(random, rows);
+	shuffleLines(random, cols);
+
+	bool transpose = (random->nextInt(2) == 1);
+
+	for (int row=0; row<g_N; row++) {
+		for (int col=0; col<g_N; col++) {
+			int cell = transpose ? ((cols[col] * g_N) + rows[row]) : ((rows[row] * g_N) + cols[col]);
+			solution[(row * g_N) + col] = values[completed[cell]];
+		}
+	}
+
+	return true;
+}
+
+// A random order of the rows (or columns) that keeps each band's rows together
+void PuzzleGenerator::shuffleLines (RandomNumbers* random, int lines[g_N]) {
+	int bands[g_n];
+	for (int band=0; band<g_n; band++) {
+		bands[band] = band;
+	}
+	random->shuffle(bands, g_n);
+
+	for (int i=0; i<g_n; i++) {
+		int* bandLines = &lines[i * g_n];
+		for (int j=0; j<g_n; j++) {
+			bandLines[j] = (bands[i] * g_n) + j;
+		}
+		random->shuffle(bandLines, g_n);
+	}
+}
+
+// Take the clues away in a random order, as long as the solution stays unique.
+// The puzzle always has exactly one solution, so once a clue is gone the only other solutions
+// there could be are ones with something else in that cell.
+// return the number of clues left
+int PuzzleGenerator::removeClues (RandomNumbers* random, BoardSolver<g_n>* boardSolver,
+	const int solution[g_N*g_N], int grid[g_N*g_N]) {
+	// For symmetric puzzles, each cell goes along with its rotation (the last cell for the first cell, etc.)
+	int cells[g_N * g_N];
+	int numCells = 0;
+	for (int cell=0; cell<g_N*g_N; cell++) {
+		grid[cell] = solution[cell];
+
+		if (!m_symmetric || (cell <= (g_N*g_N - 1 - cell))) {
+			cells[numCells++] = cell;
+		}
+	}
+
+	random->shuffle(cells, numCells);
+
+	int numClues = g_N * g_N;
+	for (int i=0; i<numCells; i++) {
+		int cell = cells[i];
+		int otherCell = m_symmetric ? (g_N*g_N - 1 - cell) : cell;
+
+		grid[cell] = -1;
+		grid[otherCell] = -1;
+
+		if (boardSolver->hasSolutionWithout(grid, cell, solution[cell]) ||
+			((otherCell != cell) && boardSolver->hasSolutionWithout(grid, otherCell, solution[otherCell]))) {
+			// put it back
+			grid[cell] = solution[cell];
+			grid[otherCell] = solution[otherCell];
+		} else {
+			numClues -= (otherCell != cell) ? 2 : 1;
+		}
+	}
+
+	return numClues;
+}
+
+bool PuzzleGenerator::generatePuzzle (int workerId, uint64_t seed, GeneratedPuzzle* entry) {
+	RandomNumbers random(seed);
+	BoardSolver<g_n>* boardSolver = m_boardSolvers[workerId];
+	SudokuSolver* solver = m_solvers[workerId];
+
+	for (entry->m_numAttempts=1; entry->m_numAttempts<=MAX_GENERATE_ATTEMPTS; entry->m_numAttempts++) {
+		int solution[g_N * g_N];
+		if (!makeFullGrid(&random, boardSolver, solution)) {
+			continue;
+		}
+
+		int grid[g_N * g_N];
+		int numClues = removeClues(&random, boardSolver, solution, grid);
+
+		for (int cell=0; cell<g_N*g_N; cell++) {
+			entry->m_puzzle[cell] = (grid[cell] >= 0) ? ('1' + grid[cell]) : '.';
+		}
+		entry->m_puzzle[g_N * g_N] = '\0';
+
+		if (m_difficulty == ANY_DIFFICULTY) {
+			return true;
+		}
+
+		if (solver->loadGameString(entry->m_puzzle) < 0) {
+			continue;
+		}
+
+		AlgorithmType difficulty = solver->rateDifficulty();
+
+		TRACE(1, "%s() attempt %d: %d clues, %s\n", __CLASSFUNCTION__, entry->m_numAttempts, numClues,
+			(difficulty < NUM_ALGORITHMS) ? algorithmToString(difficulty) : "search");
+
+		if (difficulty == m_difficulty) {
+			return true;
+		}
+	}
+
+	entry->m_numAttempts = MAX_GENERATE_ATTEMPTS;
+
+	return false;
+}
+
+int PuzzleGenerator::generate (int numPuzzles, FILE* output) {
+	double startTime = getTimeInSeconds();
+
+	m_entries.resize(numPuzzles);
+
+	// n.b., hash the puzzle number into a seed of its own (consecutive seeds would give overlapping sequences)
+	m_scheduler.run(numPuzzles, GENERATE_CHUNK_SIZE, [this] (int workerId, int begin, int end) {
+		for (int i=begin; i<end; i++) {
+			GeneratedPuzzle* entry = &m_entries[i];
+
+			entry->m_generated = generatePuzzle(workerId, RandomNumbers(m_seed + i).next(), entry);
+		}
+	});
+
+	for (int i=0; i<numPuzzles; i++) {
+		GeneratedPuzzle* entry = &m_entries[i];
+
+		if (entry->m_generated) {
+			if (output) {
+				fprintf(output, "%s\n", entry->m_puzzle);
+			}
+			m_numGenerated++;
+		} else {
+			TRACE(0, "Error: no puzzle of that difficulty in %d attempts (puzzle %d)\n", entry->m_numAttempts, i+1);
+		}
+
+		m_numAttempts += entry->m_numAttempts;
+	}
+
+	m_numPuzzles += numPuzzles;
+	m_elapsedTime += getTimeInSeconds() - startTime;
+
+	return (m_numGenerated == m_numPuzzles) ? 0 : -1;
+}
+
+void PuzzleGenerator::printSummary (FILE* fp) {
+	double puzzlesPerSecond = (m_elapsedTime > 0) ? (m_numGenerated / m_elapsedTime) : 0;
+
+	fprintf(fp, "%d puzzles: %d generated in %d attempts, %.3f seconds (%.1f puzzles/sec, %d threads, seed %llu)\n",
+		m_numPuzzles, m_numGenerated, m_numAttempts, m_elapsedTime, puzzlesPerSecond,
+		m_scheduler.getNumThreads(), (unsigned long long)m_seed);
+}
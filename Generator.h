@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "sudoku.h"
+#include "BoardSolver.h"
+#include "Scheduler.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A small, fast random number generator (splitmix64).
+// The same seed always gives the same numbers, on any platform.
+class RandomNumbers {
+	public:
+										RandomNumbers (uint64_t seed) { m_state = seed; }
+
+		uint64_t						next () {
+											uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+											z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+											z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+											return z ^ (z >> 31);
+										}
+
+		// 0..n-1
+		int								nextInt (int n) { return (int)(((next() >> 32) * n) >> 32); }
+
+		// Put values[] in a random order (Fisher-Yates)
+		void							shuffle (int values[], int numValues) {
+											for (int i=numValues-1; i>0; i--) {
+												int j = nextInt(i + 1);
+												int value = values[i];
+												values[i] = values[j];
+												values[j] = value;
+											}
+										}
+
+	protected:
+		uint64_t						m_state;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Keep trying for a puzzle of the requested difficulty this many times before giving up on it
+#define MAX_GENERATE_ATTEMPTS				10000
+
+// Any difficulty will do
+#define ANY_DIFFICULTY						-1
+
+// One puzzle in a batch
+struct GeneratedPuzzle {
+	char							m_puzzle[g_N*g_N+1];
+	int								m_numAttempts;
+	bool							m_generated;
+};
+
+// Makes new puzzles, with a unique solution each:
+// 1) a random full grid: the boxes on the diagonal don't constrain each other, so they get random
+//    permutations and the bitmask solver fills in the rest, then the values, bands, rows and columns
+//    are shuffled (so the rest isn't always filled in the same way),
+// 2) the clues are taken away in a random order (each cell along with its 180 degree rotation, for
+//    symmetric puzzles), and any clue the puzzle can't do without is put back,
+// 3) if a difficulty was asked for, the logical solver rates the puzzle (the hardest algorithm it
+//    needed) and it's thrown away if that's not the one.
+// Puzzle "i" only depends on the seed and "i", so the output is the same with any number of threads.
+class PuzzleGenerator {
+	public:
+										PuzzleGenerator (int numThreads=1);
+										~PuzzleGenerator ();
+
+		void							setSeed (uint64_t seed) { m_seed = seed; }
+		void							setSymmetric (bool symmetric) { m_symmetric = symmetric; }
+
+		// The hardest algorithm each puzzle should need: an AlgorithmType, NUM_ALGORITHMS for puzzles
+		// the algorithms can't solve on their own, or ANY_DIFFICULTY
+		void							setDifficulty (int difficulty) { m_difficulty = difficulty; }
+
+		// Write numPuzzles puzzles to "output" (if it's not NULL), one per line ('.' for blanks)
+		int								generate (int numPuzzles, FILE* output);
+		bool							generatePuzzle (int workerId, uint64_t seed, GeneratedPuzzle* entry);
+
+		// The i'th puzzle from the last call to generate() (NULL if there wasn't one)
+		const char*						getPuzzle (int i) { return m_entries[i].m_generated ? m_entries[i].m_puzzle : NULL; }
+
+		void							printSummary (FILE* fp);
+
+	protected:
+		bool							makeFullGrid (RandomNumbers* random, BoardSolver<g_n>* boardSolver, int solution[g_N*g_N]);
+		void							shuffleLines (RandomNumbers* random, int lines[g_N]);
+		int								removeClues (RandomNumbers* random, BoardSolver<g_n>* boardSolver,
+											const int solution[g_N*g_N], int grid[g_N*g_N]);
+
+		WorkStealingScheduler			m_scheduler;
+		std::vector<BoardSolver<g_n>*>	m_boardSolvers; // one per worker
+		std::vector<SudokuSolver*>		m_solvers; // one per worker, for rating
+		std::vector<GeneratedPuzzle>	m_entries;
+
+		uint64_t						m_seed;
+		bool							m_symmetric;
+		int								m_difficulty;
+
+		int								m_numPuzzles;
+		int								m_numGenerated;
+		int								m_numAttempts;
+		double							m_elapsedTime;
+};
@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Common.h"
+
+#include "ImplicationGraph.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+ImplicationGraph::ImplicationGraph () {
+	memset(m_cellMasks, 0, sizeof(m_cellMasks));
+	m_built = false;
+	memset(m_numStrongUnitLinks, 0, sizeof(m_numStrongUnitLinks));
+	memset(m_visited, 0, sizeof(m_visited));
+	m_searchId = 0;
+}
+
+void ImplicationGraph::build (Grid* grid) {
+	// Every link comes from the cells' masks, so if none of them changed (e.g., X-cycles found nothing,
+	// and now it's XY-chains' turn), the graph is already up to date
+	CandidateMask cellMasks[g_N * g_N];
+	for (int cell=0; cell<g_N*g_N; cell++) {
+		cellMasks[cell] = grid->m_cells[cell].getMask();
+	}
+
+	if (m_built && (memcmp(cellMasks, m_cellMasks, sizeof(m_cellMasks)) == 0)) {
+		return;
+	}
+
+	m_built = true;
+	memcpy(m_cellMasks, cellMasks, sizeof(m_cellMasks));
+
+	for (int value=0; value<g_N; value++) {
+		m_valueCells[value].reset();
+	}
+
+	for (int cell=0; cell<g_N*g_N; cell++) {
+		ForEachCandidate(m_cellMasks[cell], value) {
+			m_valueCells[value].set(cell);
+		}
+	}
+
+	memset(m_numStrongUnitLinks, 0, sizeof(m_numStrongUnitLinks));
+
+	// Strong links in a unit: the value's only 2 locations
+	for (int unit=0; unit<BoardTopology::NUM_UNITS; unit++) {
+		for (int value=0; value<g_N; value++) {
+			LocationMask locations = grid->m_locations[unit][value];
+			if (countCandidates(locations) != 2) {
+				continue;
+			}
+
+			int location1 = firstCandidate(locations);
+			int location2 = firstCandidate(locations & ~CandidateBit(location1));
+
+			int node1 = getNode(g_topology.m_unitCells[unit][location1], value);
+			int node2 = getNode(g_topology.m_unitCells[unit][location2], value);
+
+			m_strongUnitLinks[node1][m_numStrongUnitLinks[node1]++] = node2;
+			m_strongUnitLinks[node2][m_numStrongUnitLinks[node2]++] = node1;
+		}
+	}
+}
+
+bool ImplicationGraph::hasLinks (int node, int linkTypes) {
+	CandidateMask cellMask = m_cellMasks[getCell(node)];
+
+	return ((linkTypes & LINK_TYPE_BIT(LINK_STRONG_UNIT)) && (m_numStrongUnitLinks[node] > 0)) ||
+		((linkTypes & LINK_TYPE_BIT(LINK_STRONG_CELL)) && (countCandidates(cellMask) == 2)) ||
+		((linkTypes & LINK_TYPE_BIT(LINK_WEAK_UNIT)) &&
+			!(CellMask::peersOf(getCell(node)) & m_valueCells[getValue(node)]).isEmpty()) ||
+		((linkTypes & LINK_TYPE_BIT(LINK_WEAK_CELL)) && (countCandidates(cellMask) > 1));
+}
+
+// Follow a link from "state" to the opposite state of nextNode (if it hasn't been visited yet).
+// return true if that makes nextNode a true end for the search from "node" that would eliminate anything
+bool ImplicationGraph::visit (int node, int state, int nextNode, int* queueLength) {
+	bool isTrue = (state & 1);
+	int nextState = (nextNode * 2) + (isTrue ? 0 : 1);
+
+	if (m_visited[nextState] == m_searchId) {
+		return false;
+	}
+
+	m_visited[nextState] = m_searchId;
+	m_parent[nextState] = state;
+	m_length[nextState] = m_length[state] + 1;
+	m_queue[(*queueLength)++] = nextState;
+
+	return !isTrue && hasEliminations(node, nextNode);
+}
+
+int ImplicationGraph::search (int node, int linkTypes, int maxLength) {
+	// Start a new generation of m_visited (clearing it when the ids wrap around)
+	if (++m_searchId == 0) {
+		memset(m_visited, 0, sizeof(m_visited));
+		m_searchId = 1;
+	}
+
+	int queueLength = 0;
+	int startState = node * 2;
+
+	m_visited[startState] = m_searchId;
+	m_parent[startState] = -1;
+	m_length[startState] = 0;
+	m_queue[queueLength++] = startState;
+
+	for (int i=0; i<queueLength; i++) {
+		int state = m_queue[i];
+		if (m_length[state] >= maxLength) {
+			continue;
+		}
+
+		int stateNode = state / 2;
+		int cell = getCell(stateNode);
+		int value = getValue(stateNode);
+		CandidateMask otherValues = m_cellMasks[cell] & ~CandidateBit(value);
+
+		if (!(state & 1)) {
+			// A false node follows its strong links (to true nodes)...
+			if (linkTypes & LINK_TYPE_BIT(LINK_STRONG_UNIT)) {
+				for (int j=0; j<m_numStrongUnitLinks[stateNode]; j++) {
+					int nextNode = m_strongUnitLinks[stateNode][j];
+					if (visit(node, state, nextNode, &queueLength)) {
+						return nextNode;
+					}
+				}
+			}
+
+			if ((linkTypes & LINK_TYPE_BIT(LINK_STRONG_CELL)) && (countCandidates(otherValues) == 1)) {
+				int nextNode = getNode(cell, firstCandidate(otherValues));
+				if (visit(node, state, nextNode, &queueLength)) {
+					return nextNode;
+				}
+			}
+		} else {
+			// ... and a true node its weak links (to false nodes): the same value in every peer,
+			// and every other value in the cell
+			if (linkTypes & LINK_TYPE_BIT(LINK_WEAK_UNIT)) {
+				CellMask peers = CellMask::peersOf(cell) & m_valueCells[value];
+				while (!peers.isEmpty()) {
+					visit(node, state, getNode(peers.removeFirst(), value), &queueLength);
+				}
+			}
+
+			if (linkTypes & LINK_TYPE_BIT(LINK_WEAK_CELL)) {
+				ForEachCandidate(otherValues, otherValue) {
+					visit(node, state, getNode(cell, otherValue), &queueLength);
+				}
+			}
+		}
+	}
+
+	return -1;
+}
+
+// n.b., the same cases as SudokuSolver::chainReduction()
+bool ImplicationGraph::hasEliminations (int node1, int node2) {
+	int cell1 = getCell(node1);
+	int cell2 = getCell(node2);
+	int value1 = getValue(node1);
+	int value2 = getValue(node2);
+
+	if (cell1 == cell2) {
+		return (m_cellMasks[cell1] & ~(CandidateBit(value1) | CandidateBit(value2))) != 0;
+	}
+
+	if (value1 == value2) {
+		return !(CellMask::peersOf(cell1) & CellMask::peersOf(cell2) & m_valueCells[value1]).isEmpty();
+	}
+
+	if (g_topology.isPeer(cell1, cell2)) {
+		return (m_cellMasks[cell1] & CandidateBit(value2)) || (m_cellMasks[cell2] & CandidateBit(value1));
+	}
+
+	return false;
+}
+
+std::string ImplicationGraph::getChainString (int end) {
+	std::string str;
+
+	for (int state=(end * 2) + 1; state>=0; state=m_parent[state]) {
+		int node = state / 2;
+
+		std::string link = makeString("R%dC%d%s%d",
+			(getCell(node) / g_N) + 1, (getCell(node) % g_N) + 1, (state & 1) ? "=" : "!=", getValue(node) + 1);
+
+		str = str.empty() ? link : (link + " => " + str);
+	}
+
+	return str;
+}
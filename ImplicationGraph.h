@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sudoku.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The links between candidates, for chains (X-cycles, XY-chains and alternating inference chains).
+//
+// Each candidate is a node: (cell * g_N) + value.
+// A strong link means at least one of its two nodes is true, a weak link means at most one is:
+// 1) strong, unit: the value is only possible in those 2 cells of a row/col/box,
+// 2) strong, cell: the cell only has those 2 possible values,
+// 3) weak, unit: the same value in two cells that can see each other,
+// 4) weak, cell: two values in the same cell.
+//
+// The graph is rebuilt from the Grid's masks for each chain search (unless none of them changed).
+// Only the strong unit links are stored (a fixed slot per node, so there's nothing to allocate):
+// the others come straight from the masks as the search gets to each node (the cell's other values,
+// and the value's cells among its peers), which is a lot cheaper than writing them all out first.
+typedef enum {
+	LINK_STRONG_UNIT,
+	LINK_STRONG_CELL,
+	LINK_WEAK_UNIT,
+	LINK_WEAK_CELL,
+
+	NUM_LINK_TYPES
+} LinkType;
+
+#define LINK_TYPE_BIT(linkType)				(1 << (linkType))
+#define STRONG_LINK_TYPES					(LINK_TYPE_BIT(LINK_STRONG_UNIT) | LINK_TYPE_BIT(LINK_STRONG_CELL))
+#define WEAK_LINK_TYPES						(LINK_TYPE_BIT(LINK_WEAK_UNIT) | LINK_TYPE_BIT(LINK_WEAK_CELL))
+#define ALL_LINK_TYPES						(STRONG_LINK_TYPES | WEAK_LINK_TYPES)
+
+#define CHAIN_NUM_NODES						(g_N * g_N * g_N)
+
+// How long a chain can get (in links)
+#define MAX_CHAIN_LENGTH					16
+
+// The most strong unit links a node can have (one in each of its units)
+#define MAX_STRONG_UNIT_LINKS				NUM_COLLECTIONS
+
+class ImplicationGraph {
+	public:
+										ImplicationGraph ();
+
+		void							build (Grid* grid);
+
+		static int						getNode (int cell, int value) { return (cell * g_N) + value; }
+		static int						getCell (int node) { return node / g_N; }
+		static int						getValue (int node) { return node % g_N; }
+
+		bool							isPossible (int node) { return m_cellMasks[getCell(node)] & CandidateBit(getValue(node)); }
+		bool							hasLinks (int node, int linkTypes);
+
+		// Assume "node" is false and follow the links of the given types, alternating strong links
+		// (a false node makes the other one true) and weak links (a true node makes the other one false),
+		// breadth first, for at most maxLength links.
+		// Either "node" or whatever that makes true (the "end" of the chain) has to be true
+		// (and if "node" is its own end, it has to be true).
+		// return the first end (the shortest chain) that would eliminate anything, or -1 if there isn't one
+		int								search (int node, int linkTypes, int maxLength);
+
+		// Is there any candidate that can't be true alongside either node1 or node2?
+		bool							hasEliminations (int node1, int node2);
+
+		// The chain from the last search's start to one of its ends, as text (for tracing)
+		std::string						getChainString (int end);
+
+	protected:
+		bool							visit (int node, int state, int nextNode, int* queueLength);
+
+		CandidateMask					m_cellMasks[g_N * g_N];
+		bool							m_built;				// m_cellMasks (and everything else) are from the last build()
+		CellMask						m_valueCells[g_N];		// the cells where each value is possible
+
+		// Node "n"'s strong unit links are m_strongUnitLinks[n][0] .. m_strongUnitLinks[n][m_numStrongUnitLinks[n]-1]
+		uint16_t						m_strongUnitLinks[CHAIN_NUM_NODES][MAX_STRONG_UNIT_LINKS];
+		uint8_t							m_numStrongUnitLinks[CHAIN_NUM_NODES];
+
+		// Search state, indexed by (node * 2) + (1 if the node is true).
+		// n.b., a state has been visited by this search if its m_visited entry is m_searchId
+		uint32_t						m_visited[CHAIN_NUM_NODES * 2];
+		uint32_t						m_searchId;
+		int16_t							m_parent[CHAIN_NUM_NODES * 2];
+		uint8_t							m_length[CHAIN_NUM_NODES * 2];
+		int16_t							m_queue[CHAIN_NUM_NODES * 2];
+};
@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Common.h"
+
+#include "MinimalityChecker.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Puzzles are read, checked and written this many at a time
+#define MINIMALITY_BLOCK_SIZE				4096
+
+// Puzzles (for the uniqueness checks) and clues (for the clue checks) per unit of work handed out by the scheduler
+#define MINIMALITY_PUZZLE_CHUNK_SIZE		16
+#define MINIMALITY_CLUE_CHUNK_SIZE			8
+
+static const char* s_statusNames[NUM_MINIMALITY_STATUSES] = {
+	"no solution",
+	"not unique",
+	"minimal",
+	"not minimal",
+};
+
+const char* minimalityStatusToString (MinimalityStatus status) {
+	return s_statusNames[status];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MinimalityChecker::MinimalityChecker (int numThreads) : m_scheduler(numThreads) {
+	for (int i=0; i<m_scheduler.getNumThreads(); i++) {
+		m_boardSolvers.push_back(new BoardSolver<g_n>());
+	}
+
+	m_numPuzzles = 0;
+	memset(m_numWithStatus, 0, sizeof(m_numWithStatus));
+	m_numRedundantClues = 0;
+	m_numChecks = 0;
+	m_elapsedTime = 0;
+}
+
+MinimalityChecker::~MinimalityChecker () {
+	for (int i=0; i<m_boardSolvers.size(); i++) {
+		delete m_boardSolvers[i];
+	}
+}
+
+void MinimalityChecker::checkBlock (int numEntries) {
+	m_scheduler.run(numEntries, MINIMALITY_PUZZLE_CHUNK_SIZE, [this] (int workerId, int begin, int end) {
+		BoardSolver<g_n>* boardSolver = m_boardSolvers[workerId];
+
+		for (int i=begin; i<end; i++) {
+			MinimalityEntry* entry = &m_entries[i];
+
+			for (int cell=0; cell<g_N*g_N; cell++) {
+				entry->m_grid[cell] = (entry->m_puzzle[cell] == '-') ? -1 : (entry->m_puzzle[cell] - '1');
+			}
+
+			int solution[g_N * g_N];
+			uint64_t numSolutions = boardSolver->countSolutions(entry->m_grid, solution, 2);
+			entry->m_status = (numSolutions == 0) ? MINIMALITY_NO_SOLUTION :
+				(numSolutions == 1) ? MINIMALITY_MINIMAL : MINIMALITY_NOT_UNIQUE;
+		}
+	});
+
+	m_checks.clear();
+	for (int i=0; i<numEntries; i++) {
+		MinimalityEntry* entry = &m_entries[i];
+
+		entry->m_firstCheck = m_checks.size();
+		entry->m_numClues = 0;
+
+		if (entry->m_status != MINIMALITY_MINIMAL) {
+			continue;
+		}
+
+		for (int cell=0; cell<g_N*g_N; cell++) {
+			if (entry->m_grid[cell] >= 0) {
+				ClueCheck check = { i, cell, false };
+				m_checks.push_back(check);
+				entry->m_numClues++;
+			}
+		}
+	}
+
+	// n.b., the puzzle has exactly one solution, so it has another one without the clue
+	// if and only if it has one with something else in that cell
+	m_scheduler.run(m_checks.size(), MINIMALITY_CLUE_CHUNK_SIZE, [this] (int workerId, int begin, int end) {
+		BoardSolver<g_n>* boardSolver = m_boardSolvers[workerId];
+
+		for (int i=begin; i<end; i++) {
+			ClueCheck* check = &m_checks[i];
+
+			int grid[g_N * g_N];
+			memcpy(grid, m_entries[check->m_entry].m_grid, sizeof(grid));
+
+			int value = grid[check->m_cell];
+			grid[check->m_cell] = -1;
+
+			check->m_redundant = !boardSolver->hasSolutionWithout(grid, check->m_cell, value);
+		}
+	});
+
+	m_numChecks += m_checks.size();
+}
+
+void MinimalityChecker::printEntry (MinimalityEntry* entry, FILE* output) {
+	fprintf(output, "%s %s", entry->m_puzzle, minimalityStatusToString(entry->m_status));
+
+	for (int i=0; i<entry->m_numClues; i++) {
+		ClueCheck* check = &m_checks[entry->m_firstCheck + i];
+
+		if (check->m_redundant) {
+			fprintf(output, " R%dC%d=%c", (check->m_cell / g_N) + 1, (check->m_cell % g_N) + 1, entry->m_puzzle[check->m_cell]);
+		}
+	}
+
+	fprintf(output, "\n");
+}
+
+// "-" reads from stdin
+int MinimalityChecker::checkFile (const char* filename, FILE* output) {
+	FILE* fp = openPuzzleFile(filename);
+	if (!fp) {
+		return -1;
+	}
+
+	checkStream(fp, output);
+
+	closePuzzleFile(fp);
+
+	return 0;
+}
+
+void MinimalityChecker::checkStream (FILE* fp, FILE* output) {
+	double startTime = getTimeInSeconds();
+
+	PuzzleReader reader(fp);
+	reader.readBlocks(m_entries, MINIMALITY_BLOCK_SIZE, [this, output] (int numEntries) {
+		checkBlock(numEntries);
+
+		for (int i=0; i<numEntries; i++) {
+			MinimalityEntry* entry = &m_entries[i];
+
+			for (int j=0; j<entry->m_numClues; j++) {
+				if (m_checks[entry->m_firstCheck + j].m_redundant) {
+					entry->m_status = MINIMALITY_NOT_MINIMAL;
+					m_numRedundantClues++;
+				}
+			}
+
+			m_numWithStatus[entry->m_status]++;
+
+			if (output) {
+				printEntry(entry, output);
+			}
+		}
+
+		m_numPuzzles += numEntries;
+	});
+
+	m_elapsedTime += getTimeInSeconds() - startTime;
+}
+
+void MinimalityChecker::printSummary (FILE* fp) {
+	double puzzlesPerSecond = (m_elapsedTime > 0) ? (m_numPuzzles / m_elapsedTime) : 0;
+	double checksPerSecond = (m_elapsedTime > 0) ? (m_numChecks / m_elapsedTime) : 0;
+
+	fprintf(fp, "%d puzzles: %d minimal, %d not minimal (%d redundant clues), %d not unique, %d no solution\n",
+		m_numPuzzles, m_numWithStatus[MINIMALITY_MINIMAL], m_numWithStatus[MINIMALITY_NOT_MINIMAL], m_numRedundantClues,
+		m_numWithStatus[MINIMALITY_NOT_UNIQUE], m_numWithStatus[MINIMALITY_NO_SOLUTION]);
+	fprintf(fp, "%d clue checks in %.3f seconds (%.1f puzzles/sec, %.1f checks/sec, %d threads)\n",
+		m_numChecks, m_elapsedTime, puzzlesPerSecond, checksPerSecond, m_scheduler.getNumThreads());
+}
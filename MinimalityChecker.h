@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "sudoku.h"
+#include "BoardSolver.h"
+#include "BatchSolver.h"
+#include "Scheduler.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+typedef enum {
+	MINIMALITY_NO_SOLUTION,			// (including givens that contradict each other)
+	MINIMALITY_NOT_UNIQUE,			// more than one solution (so there's nothing to check)
+	MINIMALITY_MINIMAL,				// every clue is needed
+	MINIMALITY_NOT_MINIMAL,			// at least one clue can be taken away and the solution stays unique
+
+	NUM_MINIMALITY_STATUSES
+} MinimalityStatus;
+
+extern const char* minimalityStatusToString (MinimalityStatus);
+
+// One puzzle in a batch
+struct MinimalityEntry {
+	char							m_puzzle[PUZZLE_STRING_LENGTH+1];
+	int								m_grid[g_N*g_N]; // a value 0..g_N-1 for each clue, -1 for blanks
+	MinimalityStatus				m_status;
+	int								m_firstCheck; // its clues are m_checks[m_firstCheck] .. m_checks[m_firstCheck+m_numClues-1]
+	int								m_numClues;
+};
+
+// One clue of a puzzle in a batch
+struct ClueCheck {
+	int								m_entry;
+	int								m_cell;
+	bool							m_redundant;
+};
+
+// Checks that every clue of each puzzle in a corpus is needed: with any one of them taken away,
+// the puzzle must have more than one solution.
+// Each block of puzzles goes through the workers twice, with a BoardSolver each:
+// 1) each puzzle is checked for a unique solution,
+// 2) each clue of the unique ones is taken away, and the puzzle is checked for another solution without it.
+// The clue checks are independent, so even a single puzzle's (up to 81 of them) are spread over the workers.
+class MinimalityChecker {
+	public:
+										MinimalityChecker (int numThreads=1);
+										~MinimalityChecker ();
+
+		// Write each puzzle to "output" (if it's not NULL), followed by its status and the redundant clues, if any
+		// ("-" reads from stdin)
+		int								checkFile (const char* filename, FILE* output);
+		void							checkStream (FILE* fp, FILE* output);
+
+		void							printSummary (FILE* fp);
+
+		int								getNumPuzzles () { return m_numPuzzles; }
+		int								getNumWithStatus (MinimalityStatus status) { return m_numWithStatus[status]; }
+		int								getNumRedundantClues () { return m_numRedundantClues; }
+
+	protected:
+		void							checkBlock (int numEntries);
+		void							printEntry (MinimalityEntry* entry, FILE* output);
+
+		WorkStealingScheduler			m_scheduler;
+		std::vector<BoardSolver<g_n>*>	m_boardSolvers; // one per worker
+		std::vector<MinimalityEntry>	m_entries;
+		std::vector<ClueCheck>			m_checks;
+
+		int								m_numPuzzles;
+		int								m_numWithStatus[NUM_MINIMALITY_STATUSES];
+		int								m_numRedundantClues;
+		int								m_numChecks;
+		double							m_elapsedTime;
+};
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <thread>
+
+#include "Common.h"
+
+#include "Scheduler.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+double getTimeInSeconds () {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec + (now.tv_nsec / 1e9);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+WorkStealingScheduler::WorkStealingScheduler (int numThreads) : m_queues(numThreads > 0 ? numThreads : getDefaultNumThreads()) {
+	m_numThreads = m_queues.size();
+}
+
+int WorkStealingScheduler::getDefaultNumThreads () {
+	int numThreads = std::thread::hardware_concurrency();
+
+	return (numThreads > 0) ? numThreads : 1;
+}
+
+// Take the next chunk from our own deque, or steal one from somebody else.
+// return false when there's no work left anywhere
+bool WorkStealingScheduler::getChunk (int workerId, Chunk* chunk) {
+	{
+		WorkerQueue& queue = m_queues[workerId];
+		std::lock_guard<std::mutex> lock(queue.m_mutex);
+
+		if (!queue.m_chunks.empty()) {
+			*chunk = queue.m_chunks.front();
+			queue.m_chunks.pop_front();
+			return true;
+		}
+	}
+
+	for (int i=1; i<m_numThreads; i++) {
+		WorkerQueue& victim = m_queues[(workerId + i) % m_numThreads];
+		std::lock_guard<std::mutex> lock(victim.m_mutex);
+
+		if (!victim.m_chunks.empty()) {
+			*chunk = victim.m_chunks.back();
+			victim.m_chunks.pop_back();
+
+			TRACE(3, "%s(workerId=%d) stole [%d,%d) from worker %d\n",
+				__CLASSFUNCTION__, workerId, chunk->m_begin, chunk->m_end, (workerId + i) % m_numThreads);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void WorkStealingScheduler::runWorker (int workerId, ChunkFunction& function) {
+	Chunk chunk;
+	while (getChunk(workerId, &chunk)) {
+		function(workerId, chunk.m_begin, chunk.m_end);
+	}
+}
+
+void WorkStealingScheduler::run (int numItems, int chunkSize, ChunkFunction function) {
+	if (numItems <= 0) {
+		return;
+	}
+
+	if (chunkSize <= 0) {
+		chunkSize = 1;
+	}
+
+	// Deal out consecutive runs of chunks so each worker starts on its own part of the input
+	int numChunks = (numItems + chunkSize - 1) / chunkSize;
+	for (int i=0; i<numChunks; i++) {
+		Chunk chunk;
+		chunk.m_begin = i * chunkSize;
+		chunk.m_end = (chunk.m_begin + chunkSize < numItems) ? chunk.m_begin + chunkSize : numItems;
+
+		int workerId = (int)(((long)i * m_numThreads) / numChunks);
+		m_queues[workerId].m_chunks.push_back(chunk);
+	}
+
+	// The calling thread is worker 0
+	std::vector<std::thread> threads;
+	for (int workerId=1; workerId<m_numThreads; workerId++) {
+		threads.push_back(std::thread(&WorkStealingScheduler::runWorker, this, workerId, std::ref(function)));
+	}
+
+	runWorker(0, function);
+
+	for (int i=0; i<threads.size(); i++) {
+		threads[i].join();
+	}
+}
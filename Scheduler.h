@@ -0,0 +1,50 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A monotonic clock, for timing whole runs (-b, -m, -R, -G)
+extern double getTimeInSeconds ();
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Runs a range of independent work items on a fixed number of threads.
+//
+// The items are cut into chunks and each worker starts with its own deque
+// of consecutive chunks. A worker takes chunks from the front of its own
+// deque; once that is empty it steals from the back of another worker's
+// deque, so a few slow puzzles can't leave the other cores idle.
+class WorkStealingScheduler {
+	public:
+		// Called for items [begin, end) on the worker with the given id (0..numThreads-1)
+		typedef std::function<void (int workerId, int begin, int end)>	ChunkFunction;
+
+										WorkStealingScheduler (int numThreads);
+
+		int								getNumThreads () { return m_numThreads; }
+
+		void							run (int numItems, int chunkSize, ChunkFunction function);
+
+		static int						getDefaultNumThreads ();
+
+	protected:
+		struct Chunk {
+			int							m_begin;
+			int							m_end;
+		};
+
+		struct WorkerQueue {
+			std::mutex					m_mutex;
+			std::deque<Chunk>			m_chunks;
+		};
+
+		bool							getChunk (int workerId, Chunk* chunk);
+		void							runWorker (int workerId, ChunkFunction& function);
+
+		int								m_numThreads;
+		std::vector<WorkerQueue>		m_queues;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <type_traits>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The shape of a board with n x n boxes: which cells make up each row/col/box ("unit"),
+// which cells can see each other ("peers"), and where the boxes cross the rows and cols
+// ("intersections").
+// None of it depends on the puzzle, so it's all computed at compile time and every
+// solver shares the same read only copy.
+//
+// Cells are numbered row by row (0..NUM_CELLS-1).
+// Units are numbered rows first, then cols, then boxes (the same order as CollectionType),
+// so unit (collection * N) + i is the i'th row/col/box.
+template <int n>
+struct Topology {
+	static constexpr int				N = n * n;					// cells in a row, col or box
+	static constexpr int				NUM_CELLS = N * N;
+	static constexpr int				NUM_UNITS = 3 * N;
+	static constexpr int				NUM_PEERS = (3 * N) - (2 * n) - 1;	// 20 for a 9x9 board
+	static constexpr int				NUM_INTERSECTIONS = 2 * N * n;		// each box crosses n rows and n cols: 54 for a 9x9 board
+	static constexpr int				NUM_PEER_WORDS = (NUM_CELLS + 63) / 64;
+
+	typedef typename std::conditional<(NUM_CELLS <= 256), uint8_t, uint16_t>::type CellIndex;
+
+	// The n cells where a box and a row/col overlap
+	struct Intersection {
+		CellIndex						m_box;						// unit number of the box
+		CellIndex						m_line;						// unit number of the row/col
+		CellIndex						m_cells[n];
+		uint32_t						m_boxLocations;				// bit "i" is set if the box's i'th cell is one of them
+		uint32_t						m_lineLocations;			// ... and the same for the row/col
+	};
+
+	CellIndex							m_unitCells[NUM_UNITS][N];
+	CellIndex							m_cellUnits[NUM_CELLS][3];	// row, col and box unit numbers of each cell
+	CellIndex							m_cellPositions[NUM_CELLS][3];	// where each cell is (0..N-1) in its row, col and box
+	CellIndex							m_peers[NUM_CELLS][NUM_PEERS];
+	uint64_t							m_peerMasks[NUM_CELLS][NUM_PEER_WORDS];	// bit "j" is set if cell j is a peer
+	Intersection						m_intersections[NUM_INTERSECTIONS];
+
+	constexpr							Topology () : m_unitCells(), m_cellUnits(), m_cellPositions(), m_peers(), m_peerMasks(), m_intersections() {
+											for (int cell=0; cell<NUM_CELLS; cell++) {
+												int row = cell / N;
+												int col = cell % N;
+												int box = ((row / n) * n) + (col / n);
+
+												m_cellUnits[cell][0] = row;
+												m_cellUnits[cell][1] = N + col;
+												m_cellUnits[cell][2] = (2 * N) + box;
+
+												int positionInBox = ((row % n) * n) + (col % n);
+
+												m_cellPositions[cell][0] = col;
+												m_cellPositions[cell][1] = row;
+												m_cellPositions[cell][2] = positionInBox;
+
+												m_unitCells[row][col] = cell;
+												m_unitCells[N + col][row] = cell;
+												m_unitCells[(2 * N) + box][positionInBox] = cell;
+											}
+
+											// n.b., only look at the cells in this cell's units (looking at every pair of cells
+											// is too slow to evaluate at compile time for the bigger boards)
+											for (int cell=0; cell<NUM_CELLS; cell++) {
+												int numPeers = 0;
+
+												for (int i=0; i<3; i++) {
+													for (int j=0; j<N; j++) {
+														int other = m_unitCells[m_cellUnits[cell][i]][j];
+
+														if ((other == cell) || isPeer(cell, other)) {
+															continue;
+														}
+
+														m_peers[cell][numPeers++] = other;
+														m_peerMasks[cell][other / 64] |= (uint64_t)1 << (other % 64);
+													}
+												}
+											}
+
+											int numIntersections = 0;
+											for (int box=0; box<N; box++) {
+												int firstRow = (box / n) * n;
+												int firstCol = (box % n) * n;
+
+												for (int i=0; i<n; i++) {
+													Intersection* rowIntersection = &m_intersections[numIntersections++];
+													rowIntersection->m_box = (2 * N) + box;
+													rowIntersection->m_line = firstRow + i;
+
+													Intersection* colIntersection = &m_intersections[numIntersections++];
+													colIntersection->m_box = (2 * N) + box;
+													colIntersection->m_line = N + firstCol + i;
+
+													rowIntersection->m_boxLocations = rowIntersection->m_lineLocations = 0;
+													colIntersection->m_boxLocations = colIntersection->m_lineLocations = 0;
+
+													for (int j=0; j<n; j++) {
+														rowIntersection->m_cells[j] = ((firstRow + i) * N) + (firstCol + j);
+														colIntersection->m_cells[j] = ((firstRow + j) * N) + (firstCol + i);
+
+														rowIntersection->m_boxLocations |= (uint32_t)1 << ((i * n) + j);
+														rowIntersection->m_lineLocations |= (uint32_t)1 << (firstCol + j);
+														colIntersection->m_boxLocations |= (uint32_t)1 << ((j * n) + i);
+														colIntersection->m_lineLocations |= (uint32_t)1 << (firstRow + j);
+													}
+												}
+											}
+										}
+
+	constexpr bool						isPeer (int cell1, int cell2) const {
+											return (m_peerMasks[cell1][cell2 / 64] >> (cell2 % 64)) & 1;
+										}
+};
@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "Common.h"
+
+#include "sudoku.h"
+#include "BatchSolver.h"
+
+// Benchmark harness: solves each corpus file with each solve method and reports
+// per-puzzle latency (median, p99) and throughput.
+// A human readable table goes to stderr and one JSON object per corpus/method goes
+// to stdout, so "make bench > before.json" / "make bench > after.json" can be diffed.
+
+#define BENCH_DEFAULT_REPETITIONS		5
+
+static const char* g_solveMethodNames[NUM_SOLVE_METHODS] = {
+	"techniques",
+	"dancing-links",
+};
+
+static uint64_t getTimeInNanoseconds () {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+}
+
+// "bench-easy.txt" -> "easy"
+static std::string getCategoryName (const char* filename) {
+	const char* baseName = strrchr(filename, '/');
+	std::string category = baseName ? (baseName + 1) : filename;
+
+	if (category.compare(0, 6, "bench-") == 0) {
+		category = category.substr(6);
+	}
+
+	size_t dot = category.rfind('.');
+	if (dot != std::string::npos) {
+		category = category.substr(0, dot);
+	}
+
+	return category;
+}
+
+static int readCorpus (const char* filename, std::vector<std::string>* puzzles) {
+	FILE* fp = fopen(filename, "r");
+	if (!fp) {
+		TRACE(0, "Error: unable to open '%s'\n", filename);
+		return -1;
+	}
+
+	PuzzleReader reader(fp);
+	char puzzle[PUZZLE_STRING_LENGTH+1];
+
+	while (reader.getNextPuzzle(puzzle)) {
+		puzzles->push_back(puzzle);
+	}
+
+	fclose(fp);
+
+	return 0;
+}
+
+// Nearest-rank percentile of sorted samples
+static double getPercentile (std::vector<uint64_t>& sortedTimes, double percentile) {
+	if (sortedTimes.empty()) {
+		return 0;
+	}
+
+	int rank = (int)((percentile / 100.0) * sortedTimes.size() + 0.5);
+	rank = std::max(1, std::min(rank, (int)sortedTimes.size()));
+
+	return (double)sortedTimes[rank-1];
+}
+
+// Solve every puzzle "repetitions" times, timing each solve separately
+static bool benchCorpus (SudokuSolver* solver, const std::string& category, SolveMethodType solveMethod,
+		std::vector<std::string>& puzzles, int repetitions) {
+	std::vector<uint64_t> times;
+	times.reserve(puzzles.size() * repetitions);
+
+	int numSolved = 0;
+	uint64_t totalTime = 0;
+
+	solver->setSolveMethod(solveMethod);
+
+	for (int rep=0; rep<repetitions; rep++) {
+		for (int i=0; i<puzzles.size(); i++) {
+			uint64_t startTime = getTimeInNanoseconds();
+
+			bool solved = (solver->loadGameString(puzzles[i].c_str()) == 0);
+			if (solved) {
+				solver->solve();
+				solved = solver->isSolved();
+			}
+
+			uint64_t elapsedTime = getTimeInNanoseconds() - startTime;
+
+			times.push_back(elapsedTime);
+			totalTime += elapsedTime;
+
+			// only the first pass counts towards correctness (and it's checked outside of the timing)
+			if ((rep == 0) && solved && solver->validate()) {
+				numSolved++;
+			}
+		}
+	}
+
+	std::sort(times.begin(), times.end());
+
+	double medianUsec = getPercentile(times, 50) / 1000.0;
+	double p99Usec = getPercentile(times, 99) / 1000.0;
+	double puzzlesPerSecond = (totalTime > 0) ? (times.size() / (totalTime / 1e9)) : 0;
+
+	fprintf(stderr, "%-12s %-14s %8d %8d %12.1f %12.1f %14.1f\n",
+		category.c_str(), g_solveMethodNames[solveMethod], (int)puzzles.size(), numSolved,
+		medianUsec, p99Usec, puzzlesPerSecond);
+
+	printf("{\"category\": \"%s\", \"method\": \"%s\", \"puzzles\": %d, \"solved\": %d, \"repetitions\": %d, "
+		"\"median_usec\": %.1f, \"p99_usec\": %.1f, \"puzzles_per_sec\": %.1f}\n",
+		category.c_str(), g_solveMethodNames[solveMethod], (int)puzzles.size(), numSolved, repetitions,
+		medianUsec, p99Usec, puzzlesPerSecond);
+
+	return numSolved == puzzles.size();
+}
+
+static void printHelp (const char* argv0) {
+	printf("%s [OPTIONS] <corpus file> [<corpus file> ...]\n", argv0);
+	printf("    -r <repetitions> : solve each puzzle this many times (default %d)\n", BENCH_DEFAULT_REPETITIONS);
+	printf("    -x : only benchmark the Dancing Links (exact cover) engine\n");
+	printf("    -l : only benchmark the logical algorithms\n");
+
+	exit(0);
+}
+
+int main (int argc, char* argv[]) {
+	int repetitions = BENCH_DEFAULT_REPETITIONS;
+	bool solveMethods[NUM_SOLVE_METHODS] = { true, true };
+
+	int opt;
+	while ((opt = getopt(argc, argv, "hr:xl")) != EOF) {
+		if (opt == 'h') {
+			printHelp(argv[0]);
+		} else if (opt == 'r') {
+			repetitions = std::max(1, atoi(optarg));
+		} else if (opt == 'x') {
+			solveMethods[SOLVE_METHOD_TECHNIQUES] = false;
+		} else if (opt == 'l') {
+			solveMethods[SOLVE_METHOD_DANCING_LINKS] = false;
+		}
+	}
+
+	if (optind >= argc) {
+		printHelp(argv[0]);
+	}
+
+	SudokuSolver solver;
+	bool allSolved = true;
+
+	fprintf(stderr, "%-12s %-14s %8s %8s %12s %12s %14s\n",
+		"category", "method", "puzzles", "solved", "median usec", "p99 usec", "puzzles/sec");
+
+	for (int i=optind; i<argc; i++) {
+		std::vector<std::string> puzzles;
+		if (readCorpus(argv[i], &puzzles) < 0) {
+			allSolved = false;
+			continue;
+		}
+
+		std::string category = getCategoryName(argv[i]);
+
+		for (int method=0; method<NUM_SOLVE_METHODS; method++) {
+			if (solveMethods[method]) {
+				allSolved &= benchCorpus(&solver, category, (SolveMethodType)method, puzzles, repetitions);
+			}
+		}
+	}
+
+	return allSolved ? 0 : 1;
+}
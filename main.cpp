@@ -2,12 +2,22 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <functional>
+#include <string>
+#include <vector>
+
 #include "Common.h"
 #include "CLI.h"
 
 #include "Permutator.h"
 
 #include "sudoku.h"
+#include "BatchSolver.h"
+#include "Scheduler.h"
+#include "BoardSolver.h"
+#include "Generator.h"
+#include "MinimalityChecker.h"
+#include "DifficultyRater.h"
 
 static void testPermutator () {
 	int values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
@@ -43,6 +53,19 @@ static void printHelp (const char* argv0) {
 	printf("    -d : increase trace level\n");
 	printf("    -D <level> : set the trace level\n");
 	printf("    -s : run the solver\n");
+	printf("    -x : solve with the Dancing Links (exact cover) engine instead of the logical algorithms\n");
+	printf("    -C : also try the chains (X-cycles, XY-chains, AICs) before searching, for -s, -b and the CLI (-R always does)\n");
+	printf("    -b <filename> : solve every puzzle in the file (\"-\" for stdin), one solution (or \"<puzzle> no solution\") per line\n");
+	printf("    -m <filename> : check that every clue of each puzzle in the file is needed (\"-\" for stdin)\n");
+	printf("    -R <filename> : rate the difficulty of every puzzle in the file (\"-\" for stdin), one JSON line each, and print a histogram\n");
+	printf("    -j <threads> : number of worker threads for -b, -m, -R and -t (0 = one per core)\n");
+	printf("    -S : print per-algorithm statistics after -s, -b or -R\n");
+	printf("    -g <filename> : solve a 4x4, 9x9, 16x16 or 25x25 puzzle (values 1-9 then A-P) with the bitmask engine\n");
+	printf("    -c <limit> : count the solutions of each puzzle file (any size), up to <limit> (0 = count them all, with -j threads)\n");
+	printf("    -G <count> : generate puzzles with a unique solution, one per line\n");
+	printf("    -r <seed> : random number seed for -G (default: the time)\n");
+	printf("    -y : make the generated puzzles symmetric (180 degree rotation)\n");
+	printf("    -L <alg> : only generate puzzles that need this algorithm (see the \"alg\" command), %d = need a search\n", NUM_ALGORITHMS);
 
 	exit(0);
 }
@@ -64,27 +87,42 @@ struct TestCase {
 	const char*				m_testDescription;
 	const char*				m_gameFilename;
 	const char*				m_solutionFilename;
+	AlgorithmType			m_algorithm; // the technique the puzzle is there for (NUM_ALGORITHMS if it needs a search)
 } g_testCases [] = {
-	"naked singles", "nakedSingles.txt", "nakedSingles.solution.txt",
-	"hidden singles", "hiddenSingles.txt", "hiddenSingles.solution.txt",
-	"naked pairs", "nakedPairs.txt", "nakedPairs.solution.txt",
-	"hidden pairs", "hiddenPairs.txt", "hiddenPairs.solution.txt",
-	"naked triples", "nakedTriples.txt", "nakedTriples.solution.txt",
-	"hidden triples", "hiddenTriples.txt", "hiddenTriples.solution.txt",
-	"naked quads", "nakedQuads.txt", "nakedQuads.solution.txt",
-	"locked candidates (pointing)", "lockedCandidates-pointing.txt", "lockedCandidates-pointing.solution.txt",
-	"locked candidates (claiming)", "lockedCandidates-claiming.txt", "lockedCandidates-claiming.solution.txt",
-	"X-wings", "xwing-row.txt", "xwing-row.solution.txt",
-	"singles chain", "singlesChain1.txt", "singlesChain1.solution.txt",
-	"Y-wings", "ywing.txt", "ywing.solution.txt",
-	"swordfish", "swordfish.txt", "swordfish.solution.txt",
-	"XYZ-wings", "xyz-wing.txt", "xyz-wing.solution.txt",
+	"naked singles", "nakedSingles.txt", "nakedSingles.solution.txt", ALG_CHECK_FOR_NAKED_SINGLES,
+	"hidden singles", "hiddenSingles.txt", "hiddenSingles.solution.txt", ALG_CHECK_FOR_HIDDEN_SINGLES,
+	"naked pairs", "nakedPairs.txt", "nakedPairs.solution.txt", ALG_CHECK_FOR_NAKED_PAIRS,
+	"hidden pairs", "hiddenPairs.txt", "hiddenPairs.solution.txt", ALG_CHECK_FOR_HIDDEN_PAIRS,
+	"naked triples", "nakedTriples.txt", "nakedTriples.solution.txt", ALG_CHECK_FOR_NAKED_TRIPLES,
+	"hidden triples", "hiddenTriples.txt", "hiddenTriples.solution.txt", ALG_CHECK_FOR_HIDDEN_TRIPLES,
+	"naked quads", "nakedQuads.txt", "nakedQuads.solution.txt", ALG_CHECK_FOR_NAKED_QUADS,
+	"locked candidates (pointing)", "lockedCandidates-pointing.txt", "lockedCandidates-pointing.solution.txt", ALG_CHECK_FOR_LOCKED_CANDIDATES,
+	"locked candidates (claiming)", "lockedCandidates-claiming.txt", "lockedCandidates-claiming.solution.txt", ALG_CHECK_FOR_LOCKED_CANDIDATES,
+	"X-wings", "xwing-row.txt", "xwing-row.solution.txt", ALG_CHECK_FOR_XWINGS,
+	"singles chain", "singlesChain1.txt", "singlesChain1.solution.txt", ALG_CHECK_FOR_SINGLES_CHAINS,
+	"Y-wings", "ywing.txt", "ywing.solution.txt", ALG_CHECK_FOR_YWINGS,
+	"swordfish", "swordfish.txt", "swordfish.solution.txt", ALG_CHECK_FOR_SWORDFISH,
+	"XYZ-wings", "xyz-wing.txt", "xyz-wing.solution.txt", ALG_CHECK_FOR_XYZ_WINGS,
+	"finned fish", "finnedFish.txt", "finnedFish.solution.txt", ALG_CHECK_FOR_FINNED_FISH,
+	"X-cycles", "xCycle.txt", "xCycle.solution.txt", ALG_CHECK_FOR_X_CYCLES,
+	"XY-chains", "xyChain.txt", "xyChain.solution.txt", ALG_CHECK_FOR_XY_CHAINS,
+	"XY-chains (through a cell an elimination left bivalue)", "xyChain-bivalue.txt", "xyChain-bivalue.solution.txt", ALG_CHECK_FOR_XY_CHAINS,
+	"AICs", "aic.txt", "aic.solution.txt", ALG_CHECK_FOR_AICS,
+	"search fallback (hidden quads)", "hiddenQuads.txt", "hiddenQuads.solution.txt", NUM_ALGORITHMS,
+	"search fallback (X-wings, columns)", "xwing-col.txt", "xwing-col.solution.txt", NUM_ALGORITHMS,
+	"search fallback (XYZ-wings 1)", "xyz-wing-1.txt", "xyz-wing-1.solution.txt", NUM_ALGORITHMS,
+	"search fallback (XYZ-wings 2)", "xyz-wing-2.txt", "xyz-wing-2.solution.txt", NUM_ALGORITHMS,
 };
 
 static void testSolver () {
+	bool useChains = g_solver->getUseChains();
+
 	for (int i=0; i<ArraySize(g_testCases); i++) {
 		TestCase* testCase = &g_testCases[i];
 
+		// n.b., the chains are off by default, so they're only turned on for the puzzles that are there for them
+		g_solver->setUseChains((testCase->m_algorithm >= ALG_CHECK_FOR_X_CYCLES) && (testCase->m_algorithm < NUM_ALGORITHMS));
+
 		const char* testDescription = testCase->m_testDescription;
 		const char* gameFilename = testCase->m_gameFilename;
 		const char* solutionFilename = testCase->m_solutionFilename;
@@ -101,6 +139,16 @@ static void testSolver () {
 
 			TRACE(0, "    checking solution(%s)\n", solutionFilename);
 			status = g_solver->checkGameFile(solutionFilename);
+
+			// n.b., the search would cover up for a technique that doesn't work, so it mustn't be needed,
+			// and the technique has to have done something along the way
+			if ((status == 0) && (testCase->m_algorithm < NUM_ALGORITHMS) &&
+				((g_solver->getNumSearchNodes() != 0) ||
+				(g_solver->getSolverStats()->m_algorithms[testCase->m_algorithm].m_numSuccesses == 0))) {
+				TRACE(0, "error: %s needed %d search nodes, and had %d successes\n", algorithmToString(testCase->m_algorithm),
+					g_solver->getNumSearchNodes(), g_solver->getSolverStats()->m_algorithms[testCase->m_algorithm].m_numSuccesses);
+				status = -1;
+			}
 		}
 
 		TRACE(0, "    %s %s\n", testDescription, (status == 0 ? "PASSED" : "FAILED"));
@@ -109,6 +157,588 @@ static void testSolver () {
 			exit(0);
 		}
 	}
+
+	g_solver->setUseChains(useChains);
+}
+
+// Other board sizes, for the bitmask engine (BoardSolver)
+TestCase g_boardSizeTestCases [] = {
+	"4x4 board", "board4x4.txt", "board4x4.solution.txt", NUM_ALGORITHMS,
+	"16x16 board", "board16x16.txt", "board16x16.solution.txt", NUM_ALGORITHMS,
+	"25x25 board", "board25x25.txt", "board25x25.solution.txt", NUM_ALGORITHMS,
+};
+
+// The whole file, as a string
+static bool readFile (const char* filename, std::string* contents) {
+	FILE* fp = fopen(filename, "r");
+	if (!fp) {
+		TRACE(0, "error: unable to open '%s'\n", filename);
+		return false;
+	}
+
+	char buffer[1024];
+	size_t length;
+	while ((length = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+		contents->append(buffer, length);
+	}
+
+	fclose(fp);
+
+	return true;
+}
+
+static void testBoardSizes () {
+	for (int i=0; i<ArraySize(g_boardSizeTestCases); i++) {
+		TestCase* testCase = &g_boardSizeTestCases[i];
+
+		TRACE(0, "Test case: %s\n", testCase->m_testDescription);
+
+		std::string puzzle;
+		std::string expectedSolution;
+		int status = -1;
+
+		if (readFile(testCase->m_gameFilename, &puzzle) && readFile(testCase->m_solutionFilename, &expectedSolution)) {
+			char solution[MAX_NUM_CELLS+1];
+			char expected[MAX_NUM_CELLS+1];
+
+			// n.b., solving the solution is an easy way to get it in the same format
+			if ((solvePuzzleString(puzzle.c_str(), solution, 2) == 1) &&
+				(solvePuzzleString(expectedSolution.c_str(), expected) == 1) &&
+				(strcmp(solution, expected) == 0)) {
+				status = 0;
+			}
+		}
+
+		TRACE(0, "    %s %s\n", testCase->m_testDescription, (status == 0 ? "PASSED" : "FAILED"));
+	}
+}
+
+// Solve a puzzle of any size and print the solution one row per line
+static int solveAnySizeFile (const char* filename) {
+	std::string puzzle;
+	if (!readFile(filename, &puzzle)) {
+		return -1;
+	}
+
+	char solution[MAX_NUM_CELLS+1];
+	int numSolutions = solvePuzzleString(puzzle.c_str(), solution, 2);
+
+	if (numSolutions < 0) {
+		return -1;
+	}
+
+	if (numSolutions == 0) {
+		printf("no solution\n");
+		return -1;
+	}
+
+	int N = 1;
+	while ((N * N) < strlen(solution)) {
+		N++;
+	}
+
+	for (int row=0; row<N; row++) {
+		printf("%.*s\n", N, &solution[row * N]);
+	}
+
+	if (numSolutions > 1) {
+		printf("(more than one solution)\n");
+	}
+
+	return 0;
+}
+
+#define STRESS_TEST_THREADS		4
+#define STRESS_TEST_PASSES		20
+
+// Solve all of the test cases over and over on several threads at once,
+// each thread with its own SudokuSolver.
+// "make tsan" runs this under ThreadSanitizer to check for data races.
+static void testSolverConcurrently (int numThreads) {
+	WorkStealingScheduler scheduler(numThreads);
+
+	std::vector<SudokuSolver*> solvers;
+	std::vector<int> numFailures;
+	for (int i=0; i<scheduler.getNumThreads(); i++) {
+		solvers.push_back(new SudokuSolver());
+		numFailures.push_back(0);
+	}
+
+	TRACE(0, "Test case: concurrent solvers (%d threads, %d passes)\n",
+		scheduler.getNumThreads(), STRESS_TEST_PASSES);
+
+	int numTestCases = ArraySize(g_testCases);
+	scheduler.run(STRESS_TEST_PASSES * numTestCases, 1, [&] (int workerId, int begin, int end) {
+		SudokuSolver* solver = solvers[workerId];
+
+		for (int i=begin; i<end; i++) {
+			TestCase* testCase = &g_testCases[i % numTestCases];
+
+			int status = solver->loadGameFile(testCase->m_gameFilename);
+			if (status == 0) {
+				solver->solve();
+				status = solver->checkGameFile(testCase->m_solutionFilename);
+			}
+
+			if (status < 0) {
+				TRACE(0, "    %s FAILED on worker %d\n", testCase->m_testDescription, workerId);
+				numFailures[workerId]++;
+			}
+		}
+	});
+
+	int totalFailures = 0;
+	for (int i=0; i<solvers.size(); i++) {
+		totalFailures += numFailures[i];
+		delete solvers[i];
+	}
+
+	TRACE(0, "    concurrent solvers %s\n", (totalFailures == 0 ? "PASSED" : "FAILED"));
+}
+
+// Count the solutions of a puzzle of any size.
+// n.b., a limit of 0 counts them all
+static int countFileSolutions (const char* filename, uint64_t limit, int numThreads) {
+	std::string puzzle;
+	if (!readFile(filename, &puzzle)) {
+		return -1;
+	}
+
+	int64_t numSolutions = countPuzzleSolutions(puzzle.c_str(), (limit == 0) ? NO_SOLUTION_LIMIT : limit, numThreads);
+	if (numSolutions < 0) {
+		return -1;
+	}
+
+	printf("%s: %s%lld solution%s\n", filename, ((limit != 0) && (numSolutions >= limit)) ? "at least " : "",
+		(long long)numSolutions, (numSolutions == 1) ? "" : "s");
+
+	return 0;
+}
+
+// The number of solutions of puzzles with a known number of them, with and without a limit,
+// on one thread and split up over several
+struct SolutionCountTestCase {
+	const char*				m_testDescription;
+	const char*				m_puzzle;
+	int64_t					m_numSolutions;
+} g_solutionCountTestCases [] = {
+	"empty 4x4 board", "................", 288,
+	"4x4 board, 1 given", "1...............", 72,
+	"9x9 board, 1 solution", "..6.....8.....731..842.5..6...8....5...416...6....2...8..9.152..397.....5.....4..", 1,
+	"9x9 board, no solutions", "11...............................................................................", 0,
+	"9x9 board, 2 solutions", ".7.....589.......4...23..9....8..1....841..326.3....4.......5..2..7.4..........79", 2,
+};
+
+#define SOLUTION_COUNT_TEST_LIMIT	5
+
+static void testSolutionCounter () {
+	for (int i=0; i<ArraySize(g_solutionCountTestCases); i++) {
+		SolutionCountTestCase* testCase = &g_solutionCountTestCases[i];
+
+		TRACE(0, "Test case: solution counter (%s)\n", testCase->m_testDescription);
+
+		int64_t limitedSolutions = (testCase->m_numSolutions < SOLUTION_COUNT_TEST_LIMIT) ?
+			testCase->m_numSolutions : SOLUTION_COUNT_TEST_LIMIT;
+
+		int status = 0;
+		if ((countPuzzleSolutions(testCase->m_puzzle, NO_SOLUTION_LIMIT, 1) != testCase->m_numSolutions) ||
+			(countPuzzleSolutions(testCase->m_puzzle, NO_SOLUTION_LIMIT, STRESS_TEST_THREADS) != testCase->m_numSolutions) ||
+			(countPuzzleSolutions(testCase->m_puzzle, SOLUTION_COUNT_TEST_LIMIT) != limitedSolutions)) {
+			status = -1;
+		}
+
+		// ... and the same for SudokuSolver's count, before and after solving (the guesses a solve makes
+		// aren't clues, so they mustn't change the count)
+		if ((strlen(testCase->m_puzzle) == g_N*g_N) && (g_solver->loadGameString(testCase->m_puzzle) == 0)) {
+			if (g_solver->countSolutions(SOLUTION_COUNT_TEST_LIMIT) != limitedSolutions) {
+				status = -1;
+			}
+
+			g_solver->solve();
+
+			if (g_solver->countSolutions(SOLUTION_COUNT_TEST_LIMIT) != limitedSolutions) {
+				status = -1;
+			}
+		}
+
+		TRACE(0, "    solution counter (%s) %s\n", testCase->m_testDescription, (status == 0 ? "PASSED" : "FAILED"));
+	}
+}
+
+#define GENERATOR_TEST_PUZZLES	50
+#define GENERATOR_TEST_SEED		12345
+#define GENERATOR_DIFFICULTY_TEST_PUZZLES	5
+
+// Generated puzzles have to have exactly one solution (and be symmetric, if they're supposed to be),
+// and the same seed has to give the same puzzles with any number of threads.
+// Puzzles generated for a difficulty have to rate at that difficulty
+static void testGenerator () {
+	for (int symmetric=0; symmetric<=1; symmetric++) {
+		TRACE(0, "Test case: generator (%s)\n", symmetric ? "symmetric" : "not symmetric");
+
+		PuzzleGenerator generator(1);
+		generator.setSeed(GENERATOR_TEST_SEED);
+		generator.setSymmetric(symmetric);
+
+		PuzzleGenerator threadedGenerator(STRESS_TEST_THREADS);
+		threadedGenerator.setSeed(GENERATOR_TEST_SEED);
+		threadedGenerator.setSymmetric(symmetric);
+
+		int status = -1;
+		if ((generator.generate(GENERATOR_TEST_PUZZLES, NULL) == 0) &&
+			(threadedGenerator.generate(GENERATOR_TEST_PUZZLES, NULL) == 0)) {
+			status = 0;
+		}
+
+		for (int i=0; (status == 0) && (i<GENERATOR_TEST_PUZZLES); i++) {
+			const char* puzzle = generator.getPuzzle(i);
+			char solution[MAX_NUM_CELLS+1];
+
+			if ((strcmp(puzzle, threadedGenerator.getPuzzle(i)) != 0) ||
+				(solvePuzzleString(puzzle, solution, 2) != 1)) {
+				status = -1;
+			}
+
+			for (int cell=0; symmetric && (cell<g_N*g_N); cell++) {
+				if ((puzzle[cell] == '.') != (puzzle[g_N*g_N - 1 - cell] == '.')) {
+					status = -1;
+				}
+			}
+		}
+
+		TRACE(0, "    generator %s\n", (status == 0 ? "PASSED" : "FAILED"));
+	}
+
+	// Every puzzle generated for a difficulty has to rate at that difficulty
+	AlgorithmType difficulties[] = { ALG_CHECK_FOR_HIDDEN_SINGLES, ALG_CHECK_FOR_LOCKED_CANDIDATES };
+	for (int i=0; i<sizeof(difficulties)/sizeof(difficulties[0]); i++) {
+		TRACE(0, "Test case: generator (%s)\n", algorithmToString(difficulties[i]));
+
+		PuzzleGenerator generator(1);
+		generator.setSeed(GENERATOR_TEST_SEED);
+		generator.setDifficulty(difficulties[i]);
+
+		int status = generator.generate(GENERATOR_DIFFICULTY_TEST_PUZZLES, NULL);
+
+		SudokuSolver solver;
+		for (int j=0; (status == 0) && (j<GENERATOR_DIFFICULTY_TEST_PUZZLES); j++) {
+			if ((solver.loadGameString(generator.getPuzzle(j)) < 0) || (solver.rateDifficulty() != difficulties[i])) {
+				status = -1;
+			}
+		}
+
+		TRACE(0, "    generator %s\n", (status == 0 ? "PASSED" : "FAILED"));
+	}
+}
+
+// The same puzzles every time (with exactly one solution each), for the tests that need a corpus
+static int generateTestPuzzles (PuzzleGenerator* generator, int numPuzzles) {
+	generator->setSeed(GENERATOR_TEST_SEED);
+
+	return generator->generate(numPuzzles, NULL);
+}
+
+// Write the puzzles to a temporary file, and hand it to test() with 1 and then STRESS_TEST_THREADS threads
+// (the answers can't depend on the number of threads).
+// return -1 if test() does (or the file can't be made)
+static int testCorpus (const std::vector<std::string>& puzzles, std::function<int (FILE* fp, int numThreads)> test) {
+	for (int numThreads=1; numThreads<=STRESS_TEST_THREADS; numThreads*=STRESS_TEST_THREADS) {
+		FILE* fp = tmpfile();
+		if (!fp) {
+			return -1;
+		}
+
+		for (int i=0; i<puzzles.size(); i++) {
+			fprintf(fp, "%s\n", puzzles[i].c_str());
+		}
+		rewind(fp);
+
+		int status = test(fp, numThreads);
+		fclose(fp);
+
+		if (status < 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+#define CLUE_TEST_PUZZLES		10
+
+// Every clue of a generated puzzle is needed, so taking any one away has to leave more than one solution
+// (and the same candidates as loading the puzzle without it, before and after the algorithms have been run),
+// and putting it back has to leave just one
+static void testClueChanges () {
+	TRACE(0, "Test case: clue changes\n");
+
+	PuzzleGenerator generator(1);
+	int status = generateTestPuzzles(&generator, CLUE_TEST_PUZZLES);
+
+	SudokuSolver reloadedSolver;
+	for (int i=0; (status == 0) && (i<CLUE_TEST_PUZZLES); i++) {
+		char puzzle[MAX_NUM_CELLS+1];
+		strcpy(puzzle, generator.getPuzzle(i));
+
+		if (g_solver->loadGameString(puzzle) < 0) {
+			status = -1;
+			break;
+		}
+
+		// n.b., start from a solved board, so removeClue() has guesses to throw away
+		g_solver->solve();
+
+		for (int cell=0; cell<g_N*g_N; cell++) {
+			if (puzzle[cell] == '.') {
+				continue;
+			}
+
+			int value = puzzle[cell] - '1';
+
+			CandidateMask candidates[g_N*g_N];
+			CandidateMask reloadedCandidates[g_N*g_N];
+
+			puzzle[cell] = '.';
+			reloadedSolver.loadGameString(puzzle);
+			reloadedSolver.getCandidates(reloadedCandidates);
+			puzzle[cell] = '1' + value;
+
+			if ((g_solver->removeClue(cell) < 0) || (g_solver->getClue(cell) >= 0)) {
+				status = -1;
+				break;
+			}
+
+			g_solver->getCandidates(candidates);
+
+			if (memcmp(candidates, reloadedCandidates, sizeof(candidates)) != 0) {
+				status = -1;
+				break;
+			}
+
+			// The algorithms have to get just as far from there, too (which they won't if the indexes are off)
+			while (g_solver->tryToSolve()) { }
+			while (reloadedSolver.tryToSolve()) { }
+
+			g_solver->getCandidates(candidates);
+			reloadedSolver.getCandidates(reloadedCandidates);
+
+			if ((memcmp(candidates, reloadedCandidates, sizeof(candidates)) != 0) ||
+				!g_solver->hasSolutionWithout(cell, value) ||
+				(g_solver->countSolutions(SOLUTION_COUNT_TEST_LIMIT) < 2) ||
+				(g_solver->addClue(cell, value) < 0) ||
+				(g_solver->countSolutions(SOLUTION_COUNT_TEST_LIMIT) != 1)) {
+				status = -1;
+				break;
+			}
+		}
+	}
+
+	TRACE(0, "    clue changes %s\n", (status == 0 ? "PASSED" : "FAILED"));
+}
+
+#define BATCH_TEST_PUZZLES		10
+
+// Every puzzle gets its own line of output, in input order: its solution, or "<puzzle> no solution"
+// if it doesn't have one or breaks the rules to begin with (a clue given twice in a row, even when
+// every cell is filled in). Lines without exactly one puzzle's worth of cells are skipped, without
+// throwing the puzzles after them out of step. The answers can't depend on the number of threads.
+static void testBatchSolver () {
+	TRACE(0, "Test case: batch solver\n");
+
+	PuzzleGenerator generator(1);
+	int status = generateTestPuzzles(&generator, BATCH_TEST_PUZZLES);
+
+	std::vector<std::string> puzzles;
+	std::vector<std::string> expected;
+	for (int i=0; (status == 0) && (i<BATCH_TEST_PUZZLES); i++) {
+		char solution[MAX_NUM_CELLS+1];
+		if (solvePuzzleString(generator.getPuzzle(i), solution, 1) != 1) {
+			status = -1;
+		}
+
+		puzzles.push_back(generator.getPuzzle(i));
+		expected.push_back(solution);
+	}
+
+	if (status == 0) {
+		// n.b., the first solution, with its second value given in the first cell as well
+		std::string duplicateClue = expected[0];
+		duplicateClue[0] = duplicateClue[1];
+
+		const char* invalidPuzzles[] = { duplicateClue.c_str(), g_solutionCountTestCases[ArraySize(g_solutionCountTestCases)-2].m_puzzle };
+		for (int i=0; i<ArraySize(invalidPuzzles); i++) {
+			if (g_solver->loadGameString(invalidPuzzles[i]) == 0) {
+				status = -1;
+			}
+
+			// (the puzzle is echoed the way it was read, with '-' for the blanks)
+			std::string echoed = invalidPuzzles[i];
+			for (int j=0; j<echoed.size(); j++) {
+				if (echoed[j] == '.') {
+					echoed[j] = '-';
+				}
+			}
+
+			puzzles.insert(puzzles.begin() + (i+1)*BATCH_TEST_PUZZLES/3, invalidPuzzles[i]);
+			expected.insert(expected.begin() + (i+1)*BATCH_TEST_PUZZLES/3, echoed + " no solution");
+		}
+
+		const std::string malformedLines[] = { puzzles[0].substr(0, g_N*g_N-1), puzzles[1] + "1", "123", "# a comment", "" };
+		for (int i=0; i<ArraySize(malformedLines); i++) {
+			puzzles.insert(puzzles.begin() + 2*i + 1, malformedLines[i]);
+		}
+	}
+
+	if (status == 0) {
+		status = testCorpus(puzzles, [&expected] (FILE* fp, int numThreads) {
+			FILE* output = tmpfile();
+			if (!output) {
+				return -1;
+			}
+
+			BatchSolver batchSolver(numThreads);
+			batchSolver.solveStream(fp, output);
+			rewind(output);
+
+			int status = 0;
+			if ((batchSolver.getNumPuzzles() != expected.size()) || (batchSolver.getNumSolved() != BATCH_TEST_PUZZLES)) {
+				status = -1;
+			}
+
+			char line[1024];
+			for (int i=0; i<expected.size(); i++) {
+				if (!fgets(line, sizeof(line), output) || (strcspn(line, "\n") != expected[i].size()) ||
+					(strncmp(line, expected[i].c_str(), expected[i].size()) != 0)) {
+					status = -1;
+				}
+			}
+
+			if (fgets(line, sizeof(line), output)) {
+				status = -1;
+			}
+
+			fclose(output);
+
+			return status;
+		});
+	}
+
+	TRACE(0, "    batch solver %s\n", (status == 0 ? "PASSED" : "FAILED"));
+}
+
+#define MINIMALITY_TEST_PUZZLES	20
+
+// Generated puzzles are minimal; the same puzzle with every clue given isn't (none of them are needed),
+// and a puzzle with 2 solutions can't be checked. The answers can't depend on the number of threads.
+static void testMinimalityChecker () {
+	TRACE(0, "Test case: minimality checker\n");
+
+	PuzzleGenerator generator(1);
+	int status = generateTestPuzzles(&generator, MINIMALITY_TEST_PUZZLES);
+
+	char solution[MAX_NUM_CELLS+1];
+	if ((status < 0) || (solvePuzzleString(generator.getPuzzle(0), solution, 1) != 1)) {
+		status = -1;
+	}
+
+	if (status == 0) {
+		std::vector<std::string> puzzles;
+		for (int i=0; i<MINIMALITY_TEST_PUZZLES; i++) {
+			puzzles.push_back(generator.getPuzzle(i));
+		}
+		puzzles.push_back(solution);
+		puzzles.push_back(g_solutionCountTestCases[ArraySize(g_solutionCountTestCases)-1].m_puzzle);
+
+		status = testCorpus(puzzles, [] (FILE* fp, int numThreads) {
+			MinimalityChecker checker(numThreads);
+			checker.checkStream(fp, NULL);
+
+			if ((checker.getNumPuzzles() != MINIMALITY_TEST_PUZZLES + 2) ||
+				(checker.getNumWithStatus(MINIMALITY_MINIMAL) != MINIMALITY_TEST_PUZZLES) ||
+				(checker.getNumWithStatus(MINIMALITY_NOT_MINIMAL) != 1) ||
+				(checker.getNumWithStatus(MINIMALITY_NOT_UNIQUE) != 1) ||
+				(checker.getNumRedundantClues() != g_N*g_N)) {
+				return -1;
+			}
+
+			return 0;
+		});
+	}
+
+	TRACE(0, "    minimality checker %s\n", (status == 0 ? "PASSED" : "FAILED"));
+}
+
+#define RATING_TEST_PUZZLES		20
+
+// The ratings have to be the same as rating each puzzle on its own (even after it's been solved),
+// with any number of threads, and the puzzles without exactly one solution can't be rated
+static void testDifficultyRater () {
+	TRACE(0, "Test case: difficulty rater\n");
+
+	PuzzleGenerator generator(1);
+	int status = generateTestPuzzles(&generator, RATING_TEST_PUZZLES);
+
+	if (status == 0) {
+		std::vector<std::string> puzzles;
+		for (int i=0; i<RATING_TEST_PUZZLES; i++) {
+			puzzles.push_back(generator.getPuzzle(i));
+		}
+
+		// n.b., the solution counter's "no solutions" and "2 solutions" cases
+		puzzles.push_back(g_solutionCountTestCases[ArraySize(g_solutionCountTestCases)-2].m_puzzle);
+		puzzles.push_back(g_solutionCountTestCases[ArraySize(g_solutionCountTestCases)-1].m_puzzle);
+
+		status = testCorpus(puzzles, [&generator] (FILE* fp, int numThreads) {
+			DifficultyRater rater(numThreads);
+			rater.rateStream(fp, NULL);
+
+			int numCounted = 0;
+			for (int algorithm=0; algorithm<=NUM_ALGORITHMS; algorithm++) {
+				numCounted += rater.getHistogramCount(algorithm);
+			}
+
+			if ((rater.getNumPuzzles() != RATING_TEST_PUZZLES + 2) || (numCounted != RATING_TEST_PUZZLES) ||
+				(rater.getNumWithStatus(RATING_RATED) != RATING_TEST_PUZZLES) ||
+				(rater.getStatus(RATING_TEST_PUZZLES) != RATING_NO_SOLUTION) ||
+				(rater.getStatus(RATING_TEST_PUZZLES+1) != RATING_NOT_UNIQUE) ||
+				rater.getRating(RATING_TEST_PUZZLES) || rater.getRating(RATING_TEST_PUZZLES+1)) {
+				return -1;
+			}
+
+			for (int i=0; i<RATING_TEST_PUZZLES; i++) {
+				const char* puzzle = generator.getPuzzle(i);
+				const DifficultyRating* rating = rater.getRating(i);
+
+				// Solving the puzzle means placing a value in every blank
+				int numBlanks = 0;
+				for (int cell=0; cell<g_N*g_N; cell++) {
+					if (puzzle[cell] == '.') {
+						numBlanks++;
+					}
+				}
+
+				if (!rating || (g_solver->loadGameString(puzzle) < 0) ||
+					(g_solver->rateDifficulty() != rating->m_hardestAlgorithm) ||
+					(rating->m_needsSearch != (rating->m_hardestAlgorithm == NUM_ALGORITHMS)) ||
+					(!rating->m_needsSearch && (rating->m_numPlacements != numBlanks))) {
+					return -1;
+				}
+
+				// Rating it again, once it's been solved, has to start over from the clues
+				DifficultyRating solvedRating;
+				g_solver->solve();
+				g_solver->rateDifficulty(&solvedRating);
+
+				if (memcmp(&solvedRating, rating, sizeof(solvedRating)) != 0) {
+					return -1;
+				}
+			}
+
+			return 0;
+		});
+	}
+
+	TRACE(0, "    difficulty rater %s\n", (status == 0 ? "PASSED" : "FAILED"));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -161,6 +791,49 @@ static void processValidate (CLI* cli) {
 	g_solver->validate(1);
 }
 
+static void processCount (CLI* cli) {
+	int limit = cli->getIntParameter(false, 2);
+
+	uint64_t numSolutions = g_solver->countSolutions((limit <= 0) ? NO_SOLUTION_LIMIT : limit);
+
+	printf("%s%llu solution%s\n", ((limit > 0) && (numSolutions >= limit)) ? "at least " : "",
+		(unsigned long long)numSolutions, (numSolutions == 1) ? "" : "s");
+}
+
+// Rows, columns and values are 1..9
+static void processClue (CLI* cli) {
+	int row = cli->getIntParameter(true, 0);
+	int col = cli->getIntParameter(true, 0);
+	int value = cli->getIntParameter(true, 0);
+
+	if ((row < 1) || (row > g_N) || (col < 1) || (col > g_N) || (value < 1) || (value > g_N)) {
+		printf("Usage: clue <row> <col> <value>\n");
+		return;
+	}
+
+	if (g_solver->addClue(((row - 1) * g_N) + (col - 1), value - 1) < 0) {
+		printf("R%dC%d can't be a %d\n", row, col, value);
+	}
+}
+
+static void processUnclue (CLI* cli) {
+	int row = cli->getIntParameter(true, 0);
+	int col = cli->getIntParameter(true, 0);
+
+	if ((row < 1) || (row > g_N) || (col < 1) || (col > g_N)) {
+		printf("Usage: unclue <row> <col>\n");
+		return;
+	}
+
+	if (g_solver->removeClue(((row - 1) * g_N) + (col - 1)) < 0) {
+		printf("R%dC%d isn't a clue\n", row, col);
+	}
+}
+
+static void processStats (CLI* cli) {
+	g_solver->getSolverStats()->print(stdout);
+}
+
 static void processTest (CLI* cli) {
 	testSolver();
 }
@@ -170,9 +843,23 @@ static void processTest (CLI* cli) {
 int main (int argc, char* argv[]) {
 	bool runSolver = false;
 	bool runUnitTests = false;
+	const char* batchFilename = NULL;
+	const char* minimalityFilename = NULL;
+	const char* ratingFilename = NULL;
+	int numThreads = 1;
+	bool printStats = false;
+	const char* anySizeFilename = NULL;
+	SolveMethodType solveMethod = SOLVE_METHOD_TECHNIQUES;
+	bool useChains = false;
+	bool countSolutions = false;
+	uint64_t solutionLimit = 0;
+	int numToGenerate = 0;
+	uint64_t seed = time(NULL);
+	bool symmetric = false;
+	int difficulty = ANY_DIFFICULTY;
 
 	int opt;
-    while ((opt = getopt(argc, argv, "hvdD:st")) != EOF) {
+    while ((opt = getopt(argc, argv, "hvdD:stb:m:R:j:xCSg:c:G:r:yL:")) != EOF) {
         if (opt == 'h') {
             printHelp(argv[0]);
         } else if (opt == 'v') {
@@ -185,17 +872,126 @@ int main (int argc, char* argv[]) {
 			runSolver = true;
 		} else if (opt == 't') {
 			runUnitTests = true;
+		} else if (opt == 'b') {
+			batchFilename = optarg;
+		} else if (opt == 'm') {
+			minimalityFilename = optarg;
+		} else if (opt == 'R') {
+			ratingFilename = optarg;
+		} else if (opt == 'j') {
+			numThreads = atoi(optarg);
+		} else if (opt == 'x') {
+			solveMethod = SOLVE_METHOD_DANCING_LINKS;
+		} else if (opt == 'C') {
+			useChains = true;
+		} else if (opt == 'S') {
+			printStats = true;
+		} else if (opt == 'g') {
+			anySizeFilename = optarg;
+		} else if (opt == 'c') {
+			countSolutions = true;
+			solutionLimit = strtoull(optarg, NULL, 0);
+		} else if (opt == 'G') {
+			numToGenerate = atoi(optarg);
+		} else if (opt == 'r') {
+			seed = strtoull(optarg, NULL, 0);
+		} else if (opt == 'y') {
+			symmetric = true;
+		} else if (opt == 'L') {
+			difficulty = atoi(optarg);
+			if ((difficulty != ANY_DIFFICULTY) && ((difficulty < 0) || (difficulty > NUM_ALGORITHMS))) {
+				TRACE(0, "Error: -L must be 0..%d (or %d for any difficulty)\n", NUM_ALGORITHMS, ANY_DIFFICULTY);
+				exit(1);
+			}
 		}
     }
 
+	if (countSolutions) {
+		int status = 0;
+		for (int i=optind; i<argc; i++) {
+			if (countFileSolutions(argv[i], solutionLimit, numThreads) < 0) {
+				status = -1;
+			}
+		}
+
+		exit(status < 0 ? 1 : 0);
+	}
+
+	if (numToGenerate > 0) {
+		PuzzleGenerator generator(numThreads);
+		generator.setSeed(seed);
+		generator.setSymmetric(symmetric);
+		generator.setDifficulty(difficulty);
+
+		int status = generator.generate(numToGenerate, stdout);
+		generator.printSummary(stderr);
+
+		exit(status < 0 ? 1 : 0);
+	}
+
+	if (anySizeFilename) {
+		exit(solveAnySizeFile(anySizeFilename) < 0 ? 1 : 0);
+	}
+
+	if (minimalityFilename) {
+		MinimalityChecker checker(numThreads);
+
+		int status = checker.checkFile(minimalityFilename, stdout);
+		checker.printSummary(stderr);
+
+		exit(status < 0 ? 1 : 0);
+	}
+
+	if (ratingFilename) {
+		DifficultyRater rater(numThreads);
+
+		int status = rater.rateFile(ratingFilename, stdout);
+		rater.printSummary(stderr);
+
+		if (printStats) {
+			SolverStats solverStats;
+			rater.getSolverStats(&solverStats);
+			solverStats.print(stderr);
+		}
+
+		exit(status < 0 ? 1 : 0);
+	}
+
+	if (batchFilename) {
+		BatchSolver batchSolver(numThreads);
+		batchSolver.setSolveMethod(solveMethod);
+		batchSolver.setUseChains(useChains);
+
+		int status = batchSolver.solveFile(batchFilename, stdout);
+		batchSolver.printSummary(stderr);
+
+		if (printStats) {
+			SolverStats solverStats;
+			batchSolver.getSolverStats(&solverStats);
+			solverStats.print(stderr);
+		}
+
+		exit(status < 0 ? 1 : 0);
+	}
+
 	if (runUnitTests) {
 		//testPermutator(); // TBD: make this a real test!
 	}
 
 	g_solver = new SudokuSolver();
+	g_solver->setSolveMethod(solveMethod);
+	g_solver->setUseChains(useChains);
 
 	if (runUnitTests) {
 		testSolver();
+		testBoardSizes();
+		testSolutionCounter();
+		testGenerator();
+		testClueChanges();
+		testBatchSolver();
+		testMinimalityChecker();
+		testDifficultyRater();
+		testSolverConcurrently((numThreads == 1) ? STRESS_TEST_THREADS : numThreads);
 	}
 
 	if (optind < argc) {
@@ -204,6 +1000,9 @@ int main (int argc, char* argv[]) {
 		g_solver->print();
 		if (runSolver) {
 			g_solver->solve();
+			if (printStats) {
+				g_solver->getSolverStats()->print(stdout);
+			}
 			exit(0);
 		}
 	}
@@ -216,6 +1015,10 @@ int main (int argc, char* argv[]) {
 	cli.addCommand("run", processRun, "run the solver to completion");
 	cli.addCommand("alg", processAlgorithm, "[<alg>] : run the specified algorithm");
 	cli.addCommand("validate", processValidate, "validate the puzzle");
+	cli.addCommand("count", processCount, "[<limit>] : count the solutions, up to <limit> (default=2, 0 = all of them)");
+	cli.addCommand("clue", processClue, "<row> <col> <value> : add a clue (keeping whatever's been worked out so far)");
+	cli.addCommand("unclue", processUnclue, "<row> <col> : take a clue away");
+	cli.addCommand("stats", processStats, "print per-algorithm statistics for the current puzzle");
 	cli.addCommand("test", processTest, "run unit tests");
 
 	cli.processInput(stdin);
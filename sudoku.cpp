@@ -6,20 +6,27 @@
 #include <sys/stat.h> 
 #include <fcntl.h>
 #include <unistd.h>
+#include <time.h>
 
 #include <vector>
 
 #include "Common.h"
-#include "Permutator.h"
-
 #include "sudoku.h"
+#include "DancingLinks.h"
+#include "ImplicationGraph.h"
+#include "BoardSolver.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 
 // TBD: varName stays in scope
 #define ForEachInArray(elementType, arrayName, varName)			\
-	elementType varName = arrayName[0];							\
-	for (int varName ## _i=0; varName ## _i<ArraySize(arrayName); varName=arrayName[++varName ## _i])
+	elementType varName;										\
+	for (int varName ## _i=0; (varName ## _i<ArraySize(arrayName)) && ((varName=arrayName[varName ## _i]), true); varName ## _i++)
+
+// Same, but for an array of objects (varName points at each one)
+#define ForEachInObjectArray(elementType, arrayName, varName)	\
+	elementType* varName;										\
+	for (int varName ## _i=0; (varName ## _i<ArraySize(arrayName)) && ((varName=&arrayName[varName ## _i]), true); varName ## _i++)
 
 #define ForEachInCellArray(arrayName, varName)					\
 	ForEachInArray(Cell*, arrayName, varName)
@@ -48,6 +55,13 @@ const char* getNameForValue (int value, int numNameValuePairs, NameValuePair nam
 	return "unknown";
 }
 
+static uint64_t getTimeInNanoseconds () {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t)now.tv_sec * 1000000000) + now.tv_nsec;
+}
+
 const char* algorithmToString (AlgorithmType algorithm) {
 	NameValuePair algorithmNames[] = {
 		ALG_CHECK_FOR_NAKED_SINGLES, "naked singles",
@@ -64,6 +78,11 @@ const char* algorithmToString (AlgorithmType algorithm) {
 		ALG_CHECK_FOR_NAKED_QUADS, "naked quads",
 		ALG_CHECK_FOR_HIDDEN_QUADS, "hidden quads",
 		ALG_CHECK_FOR_XYZ_WINGS, "XYZ wings",
+		ALG_CHECK_FOR_JELLYFISH, "jellyfish",
+		ALG_CHECK_FOR_FINNED_FISH, "finned fish",
+		ALG_CHECK_FOR_X_CYCLES, "X-cycles",
+		ALG_CHECK_FOR_XY_CHAINS, "XY-chains",
+		ALG_CHECK_FOR_AICS, "AICs",
 	};
 
 	return getNameForValue(algorithm, ArraySize(algorithmNames), algorithmNames);
@@ -79,14 +98,29 @@ const char* collectionToString (CollectionType collection) {
 	return getNameForValue(collection, ArraySize(collectionNames), collectionNames);
 }
 
-const char* chainStatusToString (ChainStatusType chainStatus) {
-	NameValuePair chainStatusNames[] = {
-		CHAIN_STATUS_UNCOLORED, "uncolored",
-		CHAIN_STATUS_COLOR_RED, "red",
-		CHAIN_STATUS_COLOR_BLACK, "black",
+const char* chainColorToString (ChainColorType chainColor) {
+	NameValuePair chainColorNames[] = {
+		CHAIN_COLOR_RED, "red",
+		CHAIN_COLOR_BLACK, "black",
 	};
 
-	return getNameForValue(chainStatus, ArraySize(chainStatusNames), chainStatusNames);
+	return getNameForValue(chainColor, ArraySize(chainColorNames), chainColorNames);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string candidatesToString (CandidateMask mask) {
+	std::string str = "[";
+
+	const char* separator = "";
+	ForEachCandidate(mask, value) {
+		str += makeString("%s%d", separator, value+1);
+		separator = ",";
+	}
+
+	str += "]";
+
+	return str;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -126,19 +160,18 @@ int IntList::getLength () {
 	return size();
 }
 
-const char* IntList::toString () {
-	static char buffer[100];
-	char* p = buffer;
+std::string IntList::toString () {
+	std::string str = "[";
 
-	p += sprintf(p, "[");
 	const char* separator = "";
 	for (int i=0; i<size(); i++) {
-		p += sprintf(p, "%s%d", separator, getValue(i)+1);
+		str += makeString("%s%d", separator, getValue(i)+1);
 		separator = ",";
 	}
-	p += sprintf(p, "]");
 
-	return buffer;
+	str += "]";
+
+	return str;
 }
 
 bool IntList::onList (int value) {
@@ -151,28 +184,6 @@ bool IntList::onList (int value) {
 	return false;
 }
 
-IntList IntList::findIntersection (IntList& listA, IntList& listB) {
-	IntList intersection;
-
-	for (int i=0; i<listA.getLength(); i++) {
-		int value = listA.getValue(i);
-		if (listB.onList(value)) {
-			intersection.addValue(value);
-		}
-	}
-
-	return intersection;
-}
-
-void IntList::findUnion (IntList& otherList) {
-	for (int i=0; i<otherList.getLength(); i++) {
-		int value = otherList.getValue(i);
-		if (!onList(value)) {
-			addValue(value);
-		}
-	}
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 
 void CellList::addValue (Cell* cell) {
@@ -197,20 +208,19 @@ bool CellList::onList (Cell* cell) {
 	return false;
 }
 
-const char* CellList::toString () {
-	static char buffer[256];
-	char* p = buffer;
+std::string CellList::toString () {
+	std::string str = "[";
 
-	p += sprintf(p, "[");
 	const char* separator = "";
 	for (int i=0; i<getLength(); i++) {
 		Cell* cell = getValue(i);
-		p += sprintf(p, "%s%s", separator, cell->getName().c_str());
+		str += makeString("%s%s", separator, cell->getName().c_str());
 		separator = ",";
 	}
-	p += sprintf(p, "]");
 
-	return buffer;
+	str += "]";
+
+	return str;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -224,71 +234,113 @@ void PossibleValues::setValue (int value) {
 	m_value = value;
 }
 
-void PossibleValues::setNoLongerPossible (int value) {
-	m_possibleValues[value] = false;
-
-	adjustList();
-}
-
 void PossibleValues::reset () {
 	m_known = false;
+	m_value = -1;
+	m_mask = ALL_CANDIDATES;
+}
 
-	for (int i=0; i<g_N; i++) {
-		m_possibleValues[i] = true;
+////////////////////////////////////////////////////////////////////////////////
+
+// n.b., values only come back when a clue is removed
+void Grid::updateIndexes (int cell, CandidateMask changedValues) {
+	CandidateMask possibleValues = m_cells[cell].getMask();
+
+	// The digit-major view: the changed values are possible here now, or they aren't any more
+	for (int collection=0; collection<NUM_COLLECTIONS; collection++) {
+		LocationMask* locations = m_locations[g_topology.m_cellUnits[cell][collection]];
+		LocationMask positionBit = (1 << g_topology.m_cellPositions[cell][collection]);
+
+		ForEachCandidate(changedValues, value) {
+			if (possibleValues & CandidateBit(value)) {
+				locations[value] |= positionBit;
+			} else {
+				locations[value] &= ~positionBit;
+			}
+		}
 	}
 
-	adjustList();
-}
+	// ... and the index of bivalue/trivalue cells
+	int numPossible = countCandidates(possibleValues);
+
+	ForEachCandidate(changedValues | possibleValues, value) {
+		if ((numPossible == 2) && (possibleValues & CandidateBit(value))) {
+			m_bivalueCells[value].set(cell);
+		} else {
+			m_bivalueCells[value].clear(cell);
+		}
+	}
 
-bool PossibleValues::isPossible (int value) {
-	return !m_known && m_possibleValues[value];
+	if (numPossible == 3) {
+		m_trivalueCells.set(cell);
+	} else {
+		m_trivalueCells.clear(cell);
+	}
 }
 
-void PossibleValues::adjustList () {
-	m_list.resize(0);
+void Grid::setValue (int cell, int value) {
+	CandidateMask oldMask = m_cells[cell].getMask();
 
-	if (!m_known) {
-		for (int i=0; i<g_N; i++) {
-			if (m_possibleValues[i]) {
-				m_list.addValue(i);
-			}
+	m_cells[cell].setValue(value);
+	updateIndexes(cell, oldMask);
+
+	for (int i=0; i<NUM_COLLECTIONS; i++) {
+		m_cellSets[g_topology.m_cellUnits[cell][i]].setNoLongerPossible(value);
+	}
+
+	const CellIndex* peers = g_topology.m_peers[cell];
+	for (int i=0; i<BoardTopology::NUM_PEERS; i++) {
+		if (m_cells[peers[i]].isPossible(value)) {
+			m_cells[peers[i]].setNoLongerPossible(value);
+			updateIndexes(peers[i], CandidateBit(value));
 		}
 	}
 }
 
-////////////////////////////////////////////////////////////////////////////////
+void Grid::recomputeCandidates (int cell) {
+	CandidateMask possibleMask = ALL_CANDIDATES;
+	for (int i=0; i<NUM_COLLECTIONS; i++) {
+		possibleMask &= m_cellSets[g_topology.m_cellUnits[cell][i]].getMask();
+	}
+
+	// n.b., 0 for a clue that was just removed
+	CandidateMask oldMask = m_cells[cell].getMask();
+
+	m_cells[cell].reset();
+	m_cells[cell].setNoLongerPossible((CandidateMask)~possibleMask);
 
-// Hack alert!
-// so that deep in the bowels we know which algorithm we're working on!
-// Ideally, we'd call cell->getCurrentAlgorithm(), but I'm too lazy right now
-// to provide the chaining from cell back up to SudokuSover.
-AlgorithmType g_currentAlgorithm;
+	updateIndexes(cell, possibleMask ^ oldMask);
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Cell::Cell (int row, int col) {
+// n.b., the cell's PossibleValues live in the solver's Grid (see SudokuSolver::SudokuSolver())
+void Cell::init (int row, int col) {
 	m_row = row;
 	m_col = col;
-	m_box = (row / g_n) + (col / g_n);
-	
-	m_name = makeString("R%dC%d", m_row+1, m_col+1);
+	m_box = ((row / g_n) * g_n) + (col / g_n);
 
-	reset();
+	m_possibleValues = NULL;
+	m_solver = NULL;
 }
 
-void Cell::reset () {
-	m_possibleValues.reset();
+// So that deep in the bowels we know which algorithm we're working on!
+AlgorithmType Cell::getCurrentAlgorithm () {
+	return m_solver ? m_solver->getCurrentAlgorithm() : NUM_ALGORITHMS;
 }
 
-void Cell::adjustPossibleValuesList () {
-	m_possibleValues.adjustList();
+void Cell::reset () {
+	m_possibleValues->reset();
 }
 
 void Cell::setValue (int value) {
 	TRACE(3, "%s(row=%d, col=%d, value=%d)\n",
 		__CLASSFUNCTION__, m_row+1, m_col+1, value+1);
 
-	m_possibleValues.setValue(value);
+	CandidateMask changedValues = getPossibleMask() | CandidateBit(value);
+
+	m_possibleValues->setValue(value);
+	candidatesChanged(changedValues);
 
 	// Tell each row, col and box that this value is no longer possible
 	ForEachInCellSetArray(m_cellSets, cellSet) {
@@ -297,25 +349,34 @@ void Cell::setValue (int value) {
 }
 
 void Cell::setNoLongerPossible (int value) {
-	m_possibleValues.setNoLongerPossible(value);
+	if (isPossible(value)) {
+		m_possibleValues->setNoLongerPossible(value);
+		candidatesChanged(CandidateBit(value));
+	}
+}
+
+// Let the solver know that it's worth looking at this cell (and its row, col and box) again
+void Cell::candidatesChanged (CandidateMask changedValues) {
+	if (m_solver) {
+		m_solver->cellChanged(this, changedValues);
+	}
 }
 
 bool Cell::isPossible (int value) {
-	return m_possibleValues.isPossible(value);
+	return m_possibleValues->isPossible(value);
 }
 
 // does the "otherCell" have the same possible values as this cell
 bool Cell::haveSamePossibles (Cell* otherCell) {
 	TRACE(3, "%s(this=%s, otherCell=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), otherCell->getName().c_str());
+		__CLASSFUNCTION__, getName().c_str(), otherCell->getName().c_str());
 
-	for (int i=0; i<g_N; i++) {
-		if (otherCell->m_possibleValues.isPossible(i) && !m_possibleValues.isPossible(i)) {
-			TRACE(3, "%s(this=%s, otherCell=%s) position %d is not possible in this cell\n",
-				__CLASSFUNCTION__, m_name.c_str(), otherCell->getName().c_str(), i+1);
+	CandidateMask notPossibleHere = otherCell->getPossibleMask() & ~getPossibleMask();
+	if (notPossibleHere) {
+		TRACE(3, "%s(this=%s, otherCell=%s) position %d is not possible in this cell\n",
+			__CLASSFUNCTION__, getName().c_str(), otherCell->getName().c_str(), firstCandidate(notPossibleHere)+1);
 
-			return false;
-		}
+		return false;
 	}
 
 	return true;
@@ -323,45 +384,51 @@ bool Cell::haveSamePossibles (Cell* otherCell) {
 
 bool Cell::haveAnyOverlappingPossibles (Cell* otherCell) {
 	TRACE(3, "%s(this=%s, otherCell=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), otherCell->getName().c_str());
+		__CLASSFUNCTION__, getName().c_str(), otherCell->getName().c_str());
 
-	for (int i=0; i<g_N; i++) {
-		if (otherCell->isPossible(i) && isPossible(i)) {
-			TRACE(3, "%s(this=%s, otherCell=%s) position %d is possible in both cells\n",
-				__CLASSFUNCTION__, m_name.c_str(), otherCell->getName().c_str(), i+1);
+	CandidateMask possibleInBoth = otherCell->getPossibleMask() & getPossibleMask();
+	if (possibleInBoth) {
+		TRACE(3, "%s(this=%s, otherCell=%s) position %d is possible in both cells\n",
+			__CLASSFUNCTION__, getName().c_str(), otherCell->getName().c_str(), firstCandidate(possibleInBoth)+1);
 
-			return true;
-		}
+		return true;
 	}
 
 	return false;
 }
 
-bool Cell::tryToReduce (IntList& values, AlgorithmType algorithm) {
+bool Cell::tryToReduceCandidates (CandidateMask values, AlgorithmType algorithm) {
 	TRACE(4, "%s(this=%s, values=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), values.toString());
-
-	bool anyReductions = false;
+		__CLASSFUNCTION__, getName().c_str(), candidatesToString(values).c_str());
 
-	for (int i=0; i<values.getLength(); i++) {
-		int value = values.getValue(i);
+	CandidateMask reductions = getPossibleMask() & values;
+	if (!reductions) {
+		return false;
+	}
 
-		anyReductions |= tryToReduce(value, algorithm);
+	if (algorithm != NUM_ALGORITHMS) {
+		ForEachCandidate(reductions, value) {
+			TRACE(1, "%s cannot be a %d (%s)\n", getName().c_str(), value+1, algorithmToString(algorithm));
+		}
 	}
 
-	return anyReductions;
+	m_possibleValues->setNoLongerPossible(reductions);
+	candidatesChanged(reductions);
+
+	return true;
 }
 
 bool Cell::tryToReduce (int value, AlgorithmType algorithm) {
 	TRACE(4, "%s(this=%s, value=%d)\n",
-		__CLASSFUNCTION__, m_name.c_str(), value+1);
+		__CLASSFUNCTION__, getName().c_str(), value+1);
 
 	if (isPossible(value)) {
 		if (algorithm != NUM_ALGORITHMS) {
-			TRACE(1, "%s cannot be a %d (%s)\n", m_name.c_str(), value+1, algorithmToString(algorithm));
+			TRACE(1, "%s cannot be a %d (%s)\n", getName().c_str(), value+1, algorithmToString(algorithm));
 		}
 
-		m_possibleValues.setNoLongerPossible(value);
+		m_possibleValues->setNoLongerPossible(value);
+		candidatesChanged(CandidateBit(value));
 
 		return true;
 	}
@@ -372,84 +439,57 @@ bool Cell::tryToReduce (int value, AlgorithmType algorithm) {
 // We *think* this is a naked single. Make sure!
 bool Cell::processNakedSingle () {
 	TRACE(3, "%s(this=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str());
+		__CLASSFUNCTION__, getName().c_str());
 
-	if (m_possibleValues.getKnown()) {
-		TRACE(0, "    ERROR! value already known (%d)\n", m_possibleValues.getValue()+1);
+	if (m_possibleValues->getKnown()) {
+		TRACE(0, "    ERROR! value already known (%d)\n", m_possibleValues->getValue()+1);
 		return false;
 	}
 
-	int onlyValue = -1;
-
-	for (int i=0; i<g_N; i++) {
-		TRACE(3, "    %d: %s BE\n", i+1, isPossible(i) ? "CAN" : "CAN'T");
+	CandidateMask possibleMask = getPossibleMask();
 
-		if (isPossible(i)) {
-			if (onlyValue != -1) {
-				TRACE(0, "    ERROR! not a naked single (%d and %d)\n", onlyValue+1, i+1);
-				return false;
-			}
+	TRACE(3, "    possible values=%s\n", candidatesToString(possibleMask).c_str());
 
-			onlyValue = i;
-		}
+	if (possibleMask == 0) {
+		TRACE(0, "    ERROR! not a naked single (no possible values remain)\n");
+		return false;
 	}
 
-	if (onlyValue == -1) {
-		TRACE(0, "    ERROR! not a naked single (no possible values remain)\n");
+	if (countCandidates(possibleMask) != 1) {
+		TRACE(0, "    ERROR! not a naked single (%s)\n", candidatesToString(possibleMask).c_str());
 		return false;
 	}
 
+	int onlyValue = firstCandidate(possibleMask);
+
 	TRACE(1, "%s must be a %d (%s)\n",
-		m_name.c_str(), onlyValue+1, algorithmToString(ALG_CHECK_FOR_NAKED_SINGLES));
+		getName().c_str(), onlyValue+1, algorithmToString(ALG_CHECK_FOR_NAKED_SINGLES));
 
 	setValue(onlyValue);
 
 	return true;
 }
 
-bool Cell::areAnyOfTheseValuesPossible (IntList& values) {
+bool Cell::areAnyOfTheseValuesPossible (CandidateMask values) {
 	TRACE(3, "%s(this=%s, values=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), values.toString());
-
-	for (int i=0; i<values.getLength(); i++) {
-		int value = values.getValue(i);
-
-		if (isPossible(value)) {
-			TRACE(3, "%s(this=%s, values=%s) value[%d]=%d is possible\n",
-				__CLASSFUNCTION__, m_name.c_str(), values.toString(), i, value+1);
+		__CLASSFUNCTION__, getName().c_str(), candidatesToString(values).c_str());
 
-			return true;
-		}
-	}
-
-	return false;
+	return (getPossibleMask() & values) != 0;
 }
 
 // this cell cannot be anything other than a value on the list
-bool Cell::hiddenSubsetReduction (IntList& values) {
+bool Cell::hiddenSubsetReduction (CandidateMask values) {
 	TRACE(3, "%s(this=%s, values=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), values.toString());
+		__CLASSFUNCTION__, getName().c_str(), candidatesToString(values).c_str());
 
 	// Does this cell contain any of these n values?
 	// If so, then it *can't* be any *other* value!
-
-	bool anyReductions = false;
-
-	for (int value=0; value<g_N; value++) {
-		// If this value is on the list, we can't reduce!
-		if (values.onList(value)) {
-			continue;
-		}
-
-		anyReductions |= tryToReduce(value, g_currentAlgorithm);
-	}
-
-	return anyReductions;
+	return tryToReduceCandidates(ALL_CANDIDATES & ~values, getCurrentAlgorithm());
 }
 
-bool Cell::hiddenSubsetReduction2 (CellList& candidateCells, IntList& values) {
+bool Cell::hiddenSubsetReduction2 (CellList& candidateCells, CandidateMask values) {
 	TRACE(3, "%s(this=%s, candidateCells=%s, values=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidateCells.toString(), values.toString());
+		__CLASSFUNCTION__, getName().c_str(), candidateCells.toString().c_str(), candidatesToString(values).c_str());
 
 	bool anyReductions = false;
 
@@ -464,162 +504,107 @@ bool Cell::hiddenSubsetReduction2 (CellList& candidateCells, IntList& values) {
 // otherwise, false
 bool Cell::hasNeighbor (Cell* otherCell) {
 	TRACE(3, "%s(this=%s, otherCell=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), otherCell->getName().c_str());
-
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		if (cellSet->hasCandidateCell(otherCell)) {
-			return true;
-		}
-	}
+		__CLASSFUNCTION__, getName().c_str(), otherCell->getName().c_str());
 
-	return false;
+	return (otherCell == this) || g_topology.isPeer(getIndex(), otherCell->getIndex());
 }
 
 // Find all of the cells that are "neighbors" of both this cell and cell3.
 // For each of them, eliminate "candidate" as a possibility
 bool Cell::checkForYWingReductions (int candidate, Cell* cell3) {
 	TRACE(3, "%s(this=%s, candidate=%d, cell3=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, cell3->getName().c_str());
-
-	Cell* cell2 = this;
+		__CLASSFUNCTION__, getName().c_str(), candidate+1, cell3->getName().c_str());
 
 	bool anyReductions = false;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		TRACE(3, "%s(this=%s, c=%d, cell3=%s) checking %s\n",
-			__CLASSFUNCTION__, m_name.c_str(), candidate+1, cell3->getName().c_str(),
-			cellSet->getName().c_str());
-
-		ForEachInCellArray(cellSet->m_cells, cell) {
-			if ((cell == cell2) || (cell == cell3)) {
-				continue;
-			}
-
-			if (!cell->hasNeighbor(cell3)) {
-				continue;
-			}
-
-			anyReductions |= cell->tryToReduce(candidate, g_currentAlgorithm);
+	const CellIndex* peers = g_topology.m_peers[getIndex()];
+	for (int i=0; i<BoardTopology::NUM_PEERS; i++) {
+		if (!g_topology.isPeer(peers[i], cell3->getIndex())) {
+			continue;
 		}
+
+		Cell* cell = m_solver->getCell(peers[i]);
+		anyReductions |= cell->tryToReduce(candidate, cell->getCurrentAlgorithm());
 	}
 
 	return anyReductions;
 }
 
-bool Cell::checkForYWings (Cell* cell2) {
-	TRACE(3, "%s(this=%s) cell2=%s\n",
-		__CLASSFUNCTION__, m_name.c_str(), cell2->getName().c_str());
-
-	Cell* cell1 = this;
-	IntList* cell1PossibleValues = cell1->getPossibleValuesList();
-
-	IntList* cell2PossibleValues = cell2->getPossibleValuesList();
-	if (cell2PossibleValues->getLength() != 2) {
-		return false;
-	}
+// Y-Wing rule:
+// When this cell (the "pivot") has 2 possible values {a,b}, and it can see a cell with {a,c}
+// and another cell with {b,c} (the "pincers"), then one of the pincers has to be "c".
+// So "c" can be eliminated from every cell that can see both pincers.
+// n.b., the pincers come straight from the solver's index of bivalue cells
+bool Cell::checkForYWings () {
+	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, getName().c_str());
 
-	int a, b, c;
-	if ((cell1PossibleValues->getValue(0) == cell2PossibleValues->getValue(0)) &&
-		(cell1PossibleValues->getValue(1) != cell2PossibleValues->getValue(1))) {
-		a = cell1PossibleValues->getValue(0);
-		b = cell1PossibleValues->getValue(1);
-		c = cell2PossibleValues->getValue(1);
-	} else if ((cell1PossibleValues->getValue(0) != cell2PossibleValues->getValue(0)) &&
-			   (cell1PossibleValues->getValue(1) == cell2PossibleValues->getValue(1))) {
-		a = cell1PossibleValues->getValue(1);
-		b = cell1PossibleValues->getValue(0);
-		c = cell2PossibleValues->getValue(0);
-	} else {
+	CandidateMask possibleValues = getPossibleMask();
+	if (countCandidates(possibleValues) != 2) {
 		return false;
 	}
 
-	// "a" is shared between the two cells (cell1 and cell2)
-	// "b" is only in cell1
-	// "c" is only in cell2
+	int a = firstCandidate(possibleValues);
+	int b = firstCandidate(possibleValues & ~CandidateBit(a));
 
-	TRACE(3, "%s(this=%s) cell2=%s also 2 possible values=%s (a=%d,b=%d,c=%d)\n",
-		__CLASSFUNCTION__, m_name.c_str(), cell2->getName().c_str(),
-		cell2PossibleValues->toString(), a+1, b+1, c+1);
+	CellMask peers = CellMask::peersOf(getIndex());
+	CellMask peersWithA = peers & m_solver->getBivalueCells(a);
+	CellMask peersWithB = peers & m_solver->getBivalueCells(b);
 
 	bool anyReductions = false;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		ForEachInCellArray(cellSet->m_cells, cell3) {
-			if ((cell3 == cell1) || (cell3 == cell2)) {
-				continue;
-			}
-
-			IntList* cell3PossibleValues = cell3->getPossibleValuesList();
-			if (cell3PossibleValues->getLength() != 2) {
-				continue;
-			}
-
-			TRACE(3, "%s(this=%s) cell3=%s also 2 possible values=%s\n",
-				__CLASSFUNCTION__, m_name.c_str(), cell3->getName().c_str(),
-				cell3PossibleValues->toString());
+	ForEachCandidate(ALL_CANDIDATES & ~possibleValues, c) {
+		CellMask acPincers = peersWithA & m_solver->getBivalueCells(c);
+		if (acPincers.isEmpty()) {
+			continue;
+		}
 
-			// Make sure the values overlap correctly!
-			// cell3 *MUST* be "b" and "c"
-			if ((cell3PossibleValues->getValue(0) == b) && (cell3PossibleValues->getValue(1) == c)) {
-				; // cell3 = [b,c]
-			} else if ((cell3PossibleValues->getValue(1) == b) && (cell3PossibleValues->getValue(0) == c)) {
-				; // cell3 = [c, b]
-			} else {
-				continue;
-			}
+		CellMask bcPincers = peersWithB & m_solver->getBivalueCells(c);
 
-TRACE(2, "%s(this=%s) cell1=%s has 2 possible values=%s\n",
-__CLASSFUNCTION__, m_name.c_str(), cell1->getName().c_str(),
-cell1PossibleValues->toString());
+		while (!acPincers.isEmpty()) {
+			Cell* cell2 = m_solver->getCell(acPincers.removeFirst());
 
-TRACE(2, "%s(this=%s) cell2=%s has 2 possible values=%s\n",
-__CLASSFUNCTION__, m_name.c_str(), cell2->getName().c_str(),
-cell2PossibleValues->toString());
+			CellMask cell3s = bcPincers;
+			while (!cell3s.isEmpty()) {
+				Cell* cell3 = m_solver->getCell(cell3s.removeFirst());
 
-TRACE(2, "%s(this=%s) cell3=%s also 2 possible values=%s\n",
-__CLASSFUNCTION__, m_name.c_str(), cell3->getName().c_str(),
-cell3PossibleValues->toString());
+				TRACE(2, "%s(this=%s) pivot=%s pincers=%s,%s (a=%d,b=%d,c=%d)\n",
+					__CLASSFUNCTION__, getName().c_str(), candidatesToString(possibleValues).c_str(),
+					cell2->getName().c_str(), cell3->getName().c_str(), a+1, b+1, c+1);
 
-			anyReductions = cell2->checkForYWingReductions(c, cell3);
+				anyReductions |= cell2->checkForYWingReductions(c, cell3);
+			}
 		}
 	}
 
 	return anyReductions;
 }
 
-bool Cell::checkForYWings () {
-	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, m_name.c_str());
-
-	IntList* possibleValuesList = m_possibleValues.getList();
-	if (possibleValuesList->getLength() != 2) {
-		return false;
-	}
-
-	TRACE(3, "%s(this=%s) has 2 possible values=%s\n",
-		__CLASSFUNCTION__, m_name.c_str(), possibleValuesList->toString());
+////////////////////////////////////////////////////////////////////////////////
 
-	bool anyReductions = false;
+// n.b., the CellSet's PossibleValues live in the solver's Grid (see SudokuSolver::SudokuSolver())
+void CellSet::init (CollectionType collection, int index) {
+	m_collection = collection;
+	m_index = index;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		ForEachInCellArray(cellSet->m_cells, cell2) {
-			if (cell2 == this) {
-				continue;
-			}
+	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, getName().c_str());
 
-			anyReductions |= checkForYWings(cell2);
-		}
-	}
+	m_possibleValues = NULL;
+	m_grid = NULL;
+	m_locations = NULL;
+	m_cellIndexes = g_topology.m_unitCells[getIndex()];
 
-	return anyReductions;
+	m_solver = NULL;
+	m_cleanAlgorithms = 0;
 }
 
-////////////////////////////////////////////////////////////////////////////////
+LocationMask CellSet::getLocationsMask (CandidateMask values) {
+	LocationMask locations = 0;
 
-CellSet::CellSet (CollectionType collection, std::string name) {
-	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, name.c_str());
+	ForEachCandidate(values, value) {
+		locations |= m_locations[value];
+	}
 
-	m_collection = collection;
-	m_name = name;
+	return locations;
 }
 
 std::string CellSet::toString (int level) {
@@ -672,9 +657,9 @@ std::string CellSet::toString (int level) {
 }
 
 void CellSet::reset () {
-	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, m_name.c_str());
+	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, getName().c_str());
 
-	m_possibleValues.reset();
+	m_possibleValues->reset();
 
 	ForEachInCellArray(m_cells, cell) {
 		cell->reset();
@@ -682,16 +667,16 @@ void CellSet::reset () {
 }
 
 void CellSet::setNoLongerPossible (int value) {
-	m_possibleValues.setNoLongerPossible(value);
+	m_possibleValues->setNoLongerPossible(value);
 
 	ForEachInCellArray(m_cells, cell) {
 		cell->setNoLongerPossible(value);
 	}
 }
 
-bool CellSet::nakedSubsetReduction (CellList& cellList, IntList& values) {
+bool CellSet::nakedSubsetReduction (CellList& cellList, CandidateMask values) {
 	TRACE(3, "%s(this=%s, cellList=%s, values=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), cellList.toString(), values.toString());
+		__CLASSFUNCTION__, getName().c_str(), cellList.toString().c_str(), candidatesToString(values).c_str());
 
 	bool anyReductions = false;
 
@@ -705,60 +690,74 @@ bool CellSet::nakedSubsetReduction (CellList& cellList, IntList& values) {
 			continue;
 		}
 
-		anyReductions |= cell->tryToReduce(values, g_currentAlgorithm);
+		anyReductions |= cell->tryToReduceCandidates(values, cell->getCurrentAlgorithm());
 	}
 
 	return anyReductions;
 }
 
+// return false if the current algorithm has already scanned this CellSet and nothing has changed since.
+// Otherwise, mark it clean (any reductions made while scanning will dirty it again)
+bool CellSet::needsScan () {
+	if (!m_solver) {
+		return true;
+	}
+
+	uint32_t algorithmBit = 1 << m_solver->getCurrentAlgorithm();
+
+	if (m_cleanAlgorithms & algorithmBit) {
+		m_solver->getPropagationStats()->m_numCleanUnitsSkipped++;
+		return false;
+	}
+
+	m_cleanAlgorithms |= algorithmBit;
+
+	return true;
+}
+
 bool CellSet::checkForNakedSubsets (int n) {
-	TRACE(3, "%s(this=%s, n=%d)\n", __CLASSFUNCTION__, m_name.c_str(), n);
+	TRACE(3, "%s(this=%s, n=%d)\n", __CLASSFUNCTION__, getName().c_str(), n);
 
-	// Make a list of the candidate cells:
+	if (!needsScan()) {
+		return false;
+	}
+
+	// Make a mask of the candidate cells (by location):
 	// 1) not known,
 	// 2) <= n possible values
-	Permutator permutator(g_N);
+	// n.b., PossibleValues::getMask() is 0 for known cells
+	uint16_t candidateLocations = 0;
+	CandidateMask possibleMasks[g_N];
 	for (int location=0; location<g_N; location++) {
-		Cell* cell = m_cells[location];
-
-		if (cell->getKnown()) {
-			continue;
-		}
+		possibleMasks[location] = m_grid[m_cellIndexes[location]].getMask();
 
-		IntList* possibleValuesList = cell->getPossibleValuesList();
-		if (possibleValuesList->getLength() > n) {
-			continue;
+		int numPossible = countCandidates(possibleMasks[location]);
+		if ((numPossible > 0) && (numPossible <= n)) {
+			candidateLocations |= (1 << location);
 		}
-
-		permutator.setValue(location);
 	}
-	permutator.setNumInPermutation(n);
 
 	// Make sure we have enough
-	if (permutator.getNumValues() < n) {
+	if (countCandidates(candidateLocations) < n) {
 		return false;
 	}
 
 	bool anyReductions = false;
-	int* nextPermutation;
-	while ((nextPermutation = permutator.getNextPermutation())) {
-		// Build a CellList from the permutation
-		CellList cellList;
-
+	ForEachSubsetOfSize(g_combinations, candidateLocations, n, locations) {
 		// Keep track of the union of the possible values from the "n" cells
-		IntList possibleValuesUnion;
-
-		for (int i=0; i<n; i++) {
-			int location = nextPermutation[i];
-			Cell* cell = m_cells[location];
-			cellList.addValue(cell);
+		CandidateMask possibleValuesUnion = 0;
 
-			IntList* possibleValues = cell->getPossibleValuesList();
-
-			possibleValuesUnion.findUnion(*possibleValues);
+		ForEachCandidate(locations, location) {
+			possibleValuesUnion |= possibleMasks[location];
 		}
 
-		if (possibleValuesUnion.getLength() == n) {
+		if (countCandidates(possibleValuesUnion) == n) {
+			// Build a CellList from the subset
+			CellList cellList;
+			ForEachCandidate(locations, location) {
+				cellList.addValue(m_cells[location]);
+			}
+
 			// Special case for n==1 (hint: naked single)
 			if (n == 1) {
 				Cell* cell = cellList.getValue(0);
@@ -799,9 +798,9 @@ bool CellSet::hasAllCandidateCells (CellList& candidateCells) {
 	return true;
 }
 
-bool CellSet::hiddenSubsetReduction2 (CellList& candidateCells, IntList& values) {
+bool CellSet::hiddenSubsetReduction2 (CellList& candidateCells, CandidateMask values) {
 	TRACE(3, "%s(this=%s, candidateCells=%s, values=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidateCells.toString(), values.toString());
+		__CLASSFUNCTION__, getName().c_str(), candidateCells.toString().c_str(), candidatesToString(values).c_str());
 
 	// Does this CellSet have *ALL* of the candidateCells?
 	// If not, nothing to do here.
@@ -818,36 +817,29 @@ bool CellSet::hiddenSubsetReduction2 (CellList& candidateCells, IntList& values)
 			continue;
 		}
 
-		for (int i=0; i<values.getLength(); i++) {
-			int value = values.getValue(i);
-
-			anyReductions |= cell->tryToReduce(value, g_currentAlgorithm);
-		}
+		anyReductions |= cell->tryToReduceCandidates(values, cell->getCurrentAlgorithm());
 	}
 
 	return anyReductions;
 }
 
-bool CellSet::checkForHiddenSubsets (IntList& permutation) {
+bool CellSet::checkForHiddenSubsets (CandidateMask permutation) {
 	TRACE(3, "%s(this=%s, permutation=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), permutation.toString());
+		__CLASSFUNCTION__, getName().c_str(), candidatesToString(permutation).c_str());
 
 	bool anyReductions = false;
 
 	// Are there exactly N cells that contain any of the N values in the permutation?
-	CellList candidateCells;
-	ForEachInCellArray(m_cells, cell) {
-		if (cell->areAnyOfTheseValuesPossible(permutation)) {
-			candidateCells.addValue(cell);
+	uint16_t locations = getLocationsMask(permutation);
 
-			TRACE(3, "    cell %s contains at least one of these values (count=%d)\n",
-				cell->getName().c_str(), candidateCells.getLength());
+	if (countCandidates(locations) == countCandidates(permutation)) {
+		CellList candidateCells;
+		ForEachCandidate(locations, location) {
+			candidateCells.addValue(m_cells[location]);
 		}
-	}
 
-	if (candidateCells.getLength() == permutation.size()) {
 		TRACE(3, "%s(this=%s, permutation=%s) subset found\n",
-			__CLASSFUNCTION__, m_name.c_str(), permutation.toString());
+			__CLASSFUNCTION__, getName().c_str(), candidatesToString(permutation).c_str());
 
 		// The candidateCells can *only* have the values in the permutation
 		for (int i=0; i<candidateCells.getLength(); i++) {
@@ -866,295 +858,228 @@ bool CellSet::checkForHiddenSubsets (IntList& permutation) {
 }
 
 bool CellSet::checkForHiddenSubsets (int n) {
-	TRACE(3, "%s(this=%s, n=%d)\n", __CLASSFUNCTION__, m_name.c_str(), n);
+	TRACE(3, "%s(this=%s, n=%d)\n", __CLASSFUNCTION__, getName().c_str(), n);
+
+	if (!needsScan()) {
+		return false;
+	}
 	TRACE(3, "    %s\n", toString(1).c_str()); // toString displays the possible values
 
-	IntList* possibleValuesList = m_possibleValues.getList();
+	CandidateMask possibleValues = m_possibleValues->getMask();
 
 	// How many possible values are there?
-	int numPossibleValues = possibleValuesList->size();
+	int numPossibleValues = countCandidates(possibleValues);
 	TRACE(3, "%s(this=%s, n=%d) possibleValues=%s\n",
-		__CLASSFUNCTION__, m_name.c_str(), n, possibleValuesList->toString());
+		__CLASSFUNCTION__, getName().c_str(), n, candidatesToString(possibleValues).c_str());
 
 	if (numPossibleValues < n) {
 		return false;
 	}
 
-	Permutator permutator(g_N);
-	for (int i=0; i<numPossibleValues; i++) {
-		permutator.setValue(possibleValuesList->getValue(i));
-	}
-	permutator.setNumInPermutation(n);
-
 	bool anyReductions = false;
-	int* nextPermutation;
-	while ((nextPermutation = permutator.getNextPermutation())) {
-		IntList permutation(n, nextPermutation); // TBD: relationship between Permutator and IntList (g_N)
-
-		anyReductions |= checkForHiddenSubsets(permutation);
+	ForEachSubsetOfSize(g_combinations, possibleValues, n, permutation) {
+		anyReductions |= checkForHiddenSubsets((CandidateMask)permutation);
 	}
 
 	return anyReductions;
 }
 
-// For this row/col/box, are the cells in the locations list all in the same collection?
-bool CellSet::inSameRCB (CollectionType collection, IntList& locations) {
-	TRACE(3, "%s(this=%s, collection=%s, locations=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), collectionToString(collection), locations.toString());
+bool CellSet::validate (int level) {
+	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, getName().c_str());
 
-	Cell* cell = m_cells[locations.getValue(0)];
-	int rcb = cell->getRCB(collection);
+	bool valid = true;
 
-	for (int i=1; i<locations.getLength(); i++) {
-		cell = m_cells[locations.getValue(i)];
+	char debug[100];
+	char* p = debug;
 
-		if (cell->getRCB(collection) != rcb) {
-			return false;
+	for (int i=0; i<g_N; i++) {
+		int count = 0;
+		ForEachInCellArray(m_cells, cell) {
+			if (cell->getKnown() && (cell->getValue() == i)) {
+				count++;
+			}
+		}
+
+		if (count == 0) {
+			p+=sprintf(p, "-");
+		} else if (count == 1) {
+			p+=sprintf(p, "%d", i+1);
+		} else {
+			p+=sprintf(p, "X");
+		}
+
+		if (count > 1) {
+			TRACE(0, "%s(%s) Error >1 %d's\n", __CLASSFUNCTION__, getName().c_str(), i+1);
+			valid = false;
 		}
 	}
 
-	return true;
-}
+	if (level > 0) {
+		TRACE(0, "%s: %s\n", getName().c_str(), debug);
+	}
 
-bool CellSet::lockedCandidateReduction (int candidate, CellList& cellList) {
-	TRACE(3, "%s(this=%s, candidate=%d, cells=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, cellList.toString());
+	return valid;
+}
 
-	bool anyReductions = false;
+// return true if this CellSet can't possibly be completed:
+// 1) a value is known in more than one cell,
+// 2) an unknown cell has no possible values, or
+// 3) a value that isn't known yet has nowhere left to go
+bool CellSet::hasContradiction () {
+	CandidateMask knownValues = 0;
+	CandidateMask possibleValues = 0;
+	int numKnown = 0;
 
 	ForEachInCellArray(m_cells, cell) {
-		if (cellList.onList(cell)) {
-			continue;
+		if (cell->getKnown()) {
+			knownValues |= CandidateBit(cell->getValue());
+			numKnown++;
+		} else {
+			CandidateMask cellPossibleValues = cell->getPossibleMask();
+			if (cellPossibleValues == 0) {
+				return true;
+			}
+
+			possibleValues |= cellPossibleValues;
 		}
+	}
 
-		anyReductions |= cell->tryToReduce(candidate, g_currentAlgorithm);
+	if (countCandidates(knownValues) != numKnown) {
+		return true;
 	}
 
-	return anyReductions;
+	return (possibleValues | knownValues) != ALL_CANDIDATES;
 }
 
-bool CellSet::checkForLockedCandidate2 (int candidate, CollectionType collection, IntList& locations) {
-	TRACE(3, "%s(this=%s, candidate=%d, collection=%s, locations=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, collectionToString(collection), locations.toString());
-
-	if (!inSameRCB(collection, locations)) {
-		return false;
-	}
-
-	TRACE(2, "%s(this=%s, candidate=%d, collection=%s, locations=%s) same collection\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, collectionToString(collection), locations.toString());
+bool CellSet::tryToReduceLocations (int candidate, LocationMask locations) {
+	TRACE(3, "%s(this=%s, candidate=%d, locations=%s)\n",
+		__CLASSFUNCTION__, getName().c_str(), candidate+1, candidatesToString(locations).c_str());
 
-	// translate the "locations" to cells
-	CellList cellList;
-	for (int i=0; i<locations.getLength(); i++) {
-		int location = locations[i];
+	bool anyReductions = false;
 
+	// If "candidate" is possible in any of the locations, then it can be eliminated!
+	ForEachCandidate(locations & m_locations[candidate], location) {
 		Cell* cell = m_cells[location];
 
-		cellList.addValue(cell);
+		anyReductions |= cell->tryToReduce(candidate, cell->getCurrentAlgorithm());
 	}
 
-	// Get the appropriate CellSet
-	CellSet* cellSet = cellList.getValue(0)->getCellSet(collection);
-
-	// See if the CellSet can make any reductions
-	return cellSet->lockedCandidateReduction(candidate, cellList);
+	return anyReductions;
 }
 
-// For this row/col/box, see if the candidate number is "locked"
-bool CellSet::checkForLockedCandidate (int candidate) {
-	TRACE(3, "%s(this=%s, candidate=%d)\n", __CLASSFUNCTION__, m_name.c_str(), candidate+1);
+////////////////////////////////////////////////////////////////////////////////
+
+// The g_n locations (or rows/cols) in the i'th band of boxes
+static LocationMask bandLocations (int band) {
+	return ((1 << g_n) - 1) << (band * g_n);
+}
 
-	// What are the locations for this candidate?
-	IntList locations = getLocationsForCandidate(candidate);
+// Fish rule (X-wing for n=2, swordfish for n=3, jellyfish for n=4):
+// When there are:
+//	1) "n" rows/cols (the "base sets") where a value is only possible in 2..n cells,
+//	2) and all of those cells lie in just "n" cols/rows (the "cover sets"),
+// then the value has to go in those cells, and it can be eliminated from the rest of the cover sets.
+// With location masks, each combination of base sets is just an OR (and a fish has exactly "n" bits set).
+//
+// Finned fish: the base sets also have some extra cells (the "fins") outside the cover sets, all in one box.
+// Either a fin has the value or the fish does, so the value can only be eliminated from cells in the
+// cover sets that are also in the fins' box. (Sashimi fish, where a base set has just one cell left in
+// the cover sets, fall out of the same test.)
+bool CellSetCollection::checkForFish (int n, int candidate, bool finned) {
+	TRACE(3, "%s(this=%s, n=%d, candidate=%d, finned=%s)\n",
+		__CLASSFUNCTION__, getName().c_str(), n, candidate+1, finned ? "TRUE" : "FALSE");
+
+	// Which CellSets could be base sets? (bit "i" for the i'th CellSet)
+	// n.b., the fins are all in one box, so they add at most g_n locations
+	LocationMask locations[g_N];
+	int maxLocations = finned ? (n + g_n) : n;
+	int possibleBaseSets = 0;
 
-	TRACE(3, "%s(this=%s, candidate=%d) locations=%s\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, locations.toString());
+	for (int i=0; i<g_N; i++) {
+		locations[i] = m_cellSets[i].getLocations(candidate);
 
-	// 0 = not found, so nothing to do
-	// 1 = naked single, it'll get picked up later
-	// >3, can't be in the same row/col/box
-	if ((locations.getLength() < 2) || (locations.getLength() > 3)) {
-		return false;
+		int numLocations = countCandidates(locations[i]);
+		if ((numLocations >= 2) && (numLocations <= maxLocations)) {
+			possibleBaseSets |= (1 << i);
+		}
 	}
 
 	bool anyReductions = false;
 
-	// If this is a box, then check to see if the locations are all in the same row or col.
-	// Otherwise, if it's a row or col, see if the locations are all in the same box
-	if (m_collection == BOX_COLLECTION) {
-		anyReductions |= checkForLockedCandidate2(candidate, ROW_COLLECTION, locations);
-		anyReductions |= checkForLockedCandidate2(candidate, COL_COLLECTION, locations);
-	} else {
-		anyReductions |= checkForLockedCandidate2(candidate, BOX_COLLECTION, locations);
-	}
-
-	return anyReductions;
-}
-
-// For this row/col/box, see if any of the numbers are "locked"
-bool CellSet::checkForLockedCandidates () {
-	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, m_name.c_str());
-
-	bool anyReductions = false;
-
-	for (int candidate=0; candidate<g_N; candidate++) {
-		anyReductions |= checkForLockedCandidate(candidate);
-	}
-
-	return anyReductions;
-}
-
-bool CellSet::validate (int level) {
-	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, m_name.c_str());
-
-	bool valid = true;
-
-	char debug[100];
-	char* p = debug;
-
-	for (int i=0; i<g_N; i++) {
-		int count = 0;
-		ForEachInCellArray(m_cells, cell) {
-			if (cell->getKnown() && (cell->getValue() == i)) {
-				count++;
-			}
-		}
-
-		if (count == 0) {
-			p+=sprintf(p, "-");
-		} else if (count == 1) {
-			p+=sprintf(p, "%d", i+1);
-		} else {
-			p+=sprintf(p, "X");
+	ForEachSubsetOfSize(g_combinations, possibleBaseSets, n, baseSets) {
+		LocationMask allLocations = 0;
+		ForEachCandidate(baseSets, i) {
+			allLocations |= locations[i];
 		}
 
-		if (count > 1) {
-			TRACE(0, "%s(%s) Error >1 %d's\n", __CLASSFUNCTION__, m_name.c_str(), i+1);
-		}
-	}
+		int numLocations = countCandidates(allLocations);
 
-	if (level > 0) {
-		TRACE(0, "%s: %s\n", m_name.c_str(), debug);
-	}
+		if (!finned) {
+			if (numLocations != n) {
+				continue;
+			}
 
-	return valid;
-}
+			// The value can be eliminated from every other CellSet in these locations
+			bool anyFishReductions = false;
+			for (int i=0; i<g_N; i++) {
+				if (!(baseSets & (1 << i))) {
+					anyFishReductions |= m_cellSets[i].tryToReduceLocations(candidate, allLocations);
+				}
+			}
 
-IntList CellSet::getLocationsForCandidate (int candidate) {
-	TRACE(3, "%s(this=%s, candidate=%d)\n", __CLASSFUNCTION__, m_name.c_str(), candidate+1);
+			if (anyFishReductions) {
+				TRACE(2, "%s(this=%s, n=%d, candidate=%d) base sets=%s locations=%s\n",
+					__CLASSFUNCTION__, getName().c_str(), n, candidate+1,
+					candidatesToString(baseSets).c_str(), candidatesToString(allLocations).c_str());
 
-	IntList locations;
+				anyReductions = true;
+			}
 
-	int location = 0;
-	ForEachInCellArray(m_cells, cell) {
-		if (cell->isPossible(candidate)) {
-			locations.addValue(location);
+			continue;
 		}
 
-		location++;
-	}
-
-	return locations;
-}
-
-bool CellSet::checkForXWingReductions (int candidate, IntList& locations) {
-	TRACE(3, "%s(this=%s, candidate=%d, locations=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, locations.toString());
-
-	bool anyReductions = false;
-
-	for (int i=0; i<locations.getLength(); i++) {
-		int location = locations.getValue(i);
-
-		// If "candidate" is possible in location, then it can be eliminated!
-		Cell* cell = m_cells[location];
-
-		anyReductions |= cell->tryToReduce(candidate, g_currentAlgorithm);
-	}
-
-	return anyReductions;
-}
-
-////////////////////////////////////////////////////////////////////////////////
-
-typedef struct {
-	CellSet*		m_cellSet;
-	IntList			m_locations;
-} XWingInfo;
-
-// X-Wing rule:
-// When there are:
-//	1) only "n" possible cells for a value in each of "n" different rows/cols,
-//  2) and these candidates also lie in the same column/row,
-// then all other candidates for this value in those columns/rows can be eliminated
-bool CellSetCollection::checkForXWings (int n, int candidate) {
-	TRACE(3, "%s(this=%s, n=%d, candidate=%d)\n", __CLASSFUNCTION__, m_name.c_str(), n, candidate+1);
-
-	// Check for CellSets that have "candidate" in exactly n locations
-	XWingInfo xWingInfo[g_N];
-	int numCellSetsWithCandidateInNLocations = 0;
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		IntList locations = cellSet->getLocationsForCandidate(candidate);
-
-		TRACE(3, "%s(this=%s, candidate=%d) trying %s: locations=%s\n",
-			__CLASSFUNCTION__, m_name.c_str(), candidate+1, cellSet->getName().c_str(),
-			locations.toString());
-
-		// If this CellSet has candidate in exactly "n" locations, then save that info
-		if (locations.getLength() == n) {
-			XWingInfo* info = &xWingInfo[numCellSetsWithCandidateInNLocations++];
-			info->m_cellSet = cellSet;
-			info->m_locations = locations; // TBD: remove this "extra" copy!
+		// (without any fins, it's a plain fish)
+		if ((numLocations <= n) || (numLocations > maxLocations)) {
+			continue;
 		}
-	}
-
-	bool anyReductions = false;
 
-	// n.b., we found numCellSetsWithCandidateInNLocations CellSets.
-	// If this number is less than "n", then we're finished.
-	// If this number is equal to "n", then we need to see if the locations in all "n" match.
-	// If this number is greater than "n", then it's more complicated. We have to check
-	//     for all combinations of "n" CellSets to see if *any* match. Sorry 'bout that!
-	for (int i=0; i<numCellSetsWithCandidateInNLocations-n+1; i++) {
-		XWingInfo* infoToMatch = &xWingInfo[i];
-
-		CellSet* matchingCellSets[g_N];
-		int numMatches = 0;
-		matchingCellSets[numMatches++] = infoToMatch->m_cellSet;
-		for (int j=i+1; j<numCellSetsWithCandidateInNLocations; j++) {
-			XWingInfo* info = &xWingInfo[j];
-
-			if (infoToMatch->m_locations == info->m_locations) {
-				matchingCellSets[numMatches++] = info->m_cellSet;
+		// The fins have to be in one box: one band of locations. So everything outside of the fins'
+		// band is a cover set, and the rest of the "n" cover sets are chosen from inside it.
+		for (int finBand=0; finBand<g_n; finBand++) {
+			LocationMask bandCoverSets = allLocations & ~bandLocations(finBand);
+			int numBandCoverSets = countCandidates(bandCoverSets);
+			if (numBandCoverSets > n) {
+				continue;
 			}
-		}
 
-		// Did we have exactly "n" matches?
-		if (numMatches == n) {
-			ForEachInCellSetArray(m_cellSets, cellSet) {
-				// Make sure it's not one of the "matching" cellSets
-				bool isOneOfTheMatchingCellSets = false;
-				for (int i=0; i<n; i++) {
-					if (cellSet == matchingCellSets[i]) {
-						isOneOfTheMatchingCellSets = true;
-						break;
+			// n.b., there are more than "n" locations, so there's always at least one fin
+			ForEachSubsetOfSize(g_combinations, allLocations & bandLocations(finBand), n - numBandCoverSets, moreCoverSets) {
+				LocationMask coverSets = bandCoverSets | moreCoverSets;
+				LocationMask fins = allLocations & ~coverSets;
+
+				// ... in base sets from one band
+				int finBaseSets = 0;
+				ForEachCandidate(baseSets, i) {
+					if (locations[i] & fins) {
+						finBaseSets |= (1 << i);
 					}
 				}
-				if (isOneOfTheMatchingCellSets) {
+
+				int finBaseBand = firstCandidate(finBaseSets) / g_n;
+				if (finBaseSets & ~bandLocations(finBaseBand)) {
 					continue;
 				}
 
-				bool status = cellSet->checkForXWingReductions(candidate, infoToMatch->m_locations);
-				if (status) {
-					TRACE(2, "%s(this=%s, n=%d, candidate=%d) locations=%s\n",
-						__CLASSFUNCTION__, m_name.c_str(), n, candidate+1,
-						infoToMatch->m_locations.toString());
+				// The value can be eliminated from the cover sets in the fins' box (outside of the base sets)
+				bool anyFishReductions = false;
+				ForEachCandidate(bandLocations(finBaseBand) & ~baseSets, i) {
+					anyFishReductions |= m_cellSets[i].tryToReduceLocations(candidate, coverSets & bandLocations(finBand));
+				}
 
-					for (int i=0; i<n; i++) {
-						CellSet* cs = matchingCellSets[i];
-						TRACE(2, "    %s\n", cs->getName().c_str());
-					}
+				if (anyFishReductions) {
+					TRACE(2, "%s(this=%s, n=%d, candidate=%d) base sets=%s cover sets=%s fins=%s\n",
+						__CLASSFUNCTION__, getName().c_str(), n, candidate+1, candidatesToString(baseSets).c_str(),
+						candidatesToString(coverSets).c_str(), candidatesToString(fins).c_str());
 
 					anyReductions = true;
 				}
@@ -1171,7 +1096,7 @@ void CellSetCollection::print (int level) {
 	}
 
 	int row=0;
-	ForEachInCellSetArray(m_cellSets, cellSet) {
+	ForEachInObjectArray(CellSet, m_cellSets, cellSet) {
 		std::string str = cellSet->toString(level);
 
 		if ((row++ % g_n) == (g_n - 1)) {
@@ -1182,33 +1107,21 @@ void CellSetCollection::print (int level) {
 	}
 }
 
-bool CellSetCollection::checkForLockedCandidates () {
-	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, m_name.c_str());
-
-	bool anyReductions = false;
-
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		anyReductions |= cellSet->checkForLockedCandidates();
-	}
-
-	return anyReductions;
-}
-
 void CellSetCollection::reset () {
-	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, m_name.c_str());
+	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, getName().c_str());
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
+	ForEachInObjectArray(CellSet, m_cellSets, cellSet) {
 		cellSet->reset();
 	}
 }
 
 bool CellSetCollection::checkForNakedSubsets (int n) {
 	TRACE(3, "%s(this=%s, n=%d)\n",
-		__CLASSFUNCTION__, m_name.c_str(), n);
+		__CLASSFUNCTION__, getName().c_str(), n);
 
 	bool anyReductions = false;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
+	ForEachInObjectArray(CellSet, m_cellSets, cellSet) {
 		anyReductions |= cellSet->checkForNakedSubsets(n);
 	}
 
@@ -1217,23 +1130,33 @@ bool CellSetCollection::checkForNakedSubsets (int n) {
 
 bool CellSetCollection::checkForHiddenSubsets (int n) {
 	TRACE(3, "%s(this=%s, n=%d)\n",
-		__CLASSFUNCTION__, m_name.c_str(), n);
+		__CLASSFUNCTION__, getName().c_str(), n);
 
 	bool anyReductions = false;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
+	ForEachInObjectArray(CellSet, m_cellSets, cellSet) {
 		anyReductions |= cellSet->checkForHiddenSubsets(n);
 	}
 
 	return anyReductions;
 }
 
+bool CellSetCollection::hasContradiction () {
+	ForEachInObjectArray(CellSet, m_cellSets, cellSet) {
+		if (cellSet->hasContradiction()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
 bool CellSetCollection::validate (int level) {
-	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, m_name.c_str());
+	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, getName().c_str());
 
 	bool valid = true;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
+	ForEachInObjectArray(CellSet, m_cellSets, cellSet) {
 		valid &= cellSet->validate(level);
 	}
 
@@ -1242,16 +1165,28 @@ bool CellSetCollection::validate (int level) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-bool AllCells::checkForYWings () {
-	TRACE(3, "%s()\n", __CLASSFUNCTION__);
+// Find the unknown cell with the fewest possible values (NULL if every cell is known)
+Cell* AllCells::findMostConstrainedCell () {
+	Cell* bestCell = NULL;
+	int bestNumPossible = g_N + 1;
 
-	bool anyReductions = false;
+	ForEachInObjectArray(Cell, m_cells, cell) {
+		if (cell->getKnown()) {
+			continue;
+		}
+
+		int numPossible = cell->getNumPossible();
+		if (numPossible < bestNumPossible) {
+			bestCell = cell;
+			bestNumPossible = numPossible;
 
-	for (int i=0; i<ArraySize(m_cells)-2; i++) {
-		anyReductions |= m_cells[i]->checkForYWings();
+			if (numPossible <= 2) {
+				break;
+			}
+		}
 	}
 
-	return anyReductions;
+	return bestCell;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1261,30 +1196,61 @@ SudokuSolver::SudokuSolver () {
 	m_cellSetCollections[COL_COLLECTION] = &m_allCols;
 	m_cellSetCollections[BOX_COLLECTION] = &m_allBoxes;
 
-	// initialize the collections
-	for (int row=0; row<g_N; row++) {
-		for (int col=0; col<g_N; col++) {
-			Cell* cell = m_allCells.getCell(row, col);
+	m_currentAlgorithm = NUM_ALGORITHMS;
+	m_searchDepth = 0;
+	m_numSearchNodes = 0;
 
-			ForEachInCellSetCollectionArray(m_cellSetCollections, cellSetCollection) {
-				cellSetCollection->setCell(row, col, cell);
-			}
+	m_cellQueueLength = 0;
+	m_cellSetQueueLength = 0;
+	memset(m_cellQueued, 0, sizeof(m_cellQueued));
+	memset(m_cellSetQueued, 0, sizeof(m_cellSetQueued));
+
+	m_solveMethod = SOLVE_METHOD_TECHNIQUES;
+	m_useChains = false;
+	m_dancingLinks = NULL;
+	m_implicationGraph = NULL;
+	m_boardSolver = NULL;
+
+	// point everything at this solver's Grid, and wire up the rows/cols/boxes from the (shared) topology
+	for (int i=0; i<BoardTopology::NUM_CELLS; i++) {
+		Cell* cell = m_allCells.getCell(i);
+		cell->setSolver(this);
+		cell->setPossibleValues(&m_grid.m_cells[i]);
+	}
+
+	for (int unit=0; unit<BoardTopology::NUM_UNITS; unit++) {
+		CellSet* cellSet = getCellSet(unit);
+		cellSet->setSolver(this);
+		cellSet->setGrid(&m_grid);
+
+		for (int i=0; i<g_N; i++) {
+			cellSet->setCell(i, m_allCells.getCell(g_topology.m_unitCells[unit][i]));
 		}
 	}
 
 	reset(); // for good measure
 }
 
+SudokuSolver::~SudokuSolver () {
+	delete m_dancingLinks;
+	delete m_implicationGraph;
+	delete m_boardSolver;
+}
+
 int SudokuSolver::loadGameString (const char* gameString) {
 	reset();
 
 	for (int row=0; row<g_N; ) {
 		for (int col=0; col<g_N; gameString++) {
-			if (*gameString == '-') {
+			if (*gameString == '\0') {
+				TRACE(0, "%s() error: game ends at row %d col %d\n", __CLASSFUNCTION__, row+1, col+1);
+				return -1;
+			} else if ((*gameString == '-') || (*gameString == '.') || (*gameString == '0')) {
 				// blank
 			} else if ((*gameString >= '1') && (*gameString <= '9')) {
 				int value = *gameString - '1';
 				m_allCells.getCell(row, col)->setValue(value);
+				m_clues[(row * g_N) + col] = value;
 			} else {
 				// anything else is window dressing
 				continue;
@@ -1296,6 +1262,8 @@ int SudokuSolver::loadGameString (const char* gameString) {
 		row++;
 	}
 
+	m_clueGrid = m_grid;
+
 	 return validate() ? 0 : -1;
 }
 
@@ -1332,42 +1300,76 @@ int SudokuSolver::checkGameString (const char* gameString) {
 	return 0;
 }
 
-char* readGameFile (const char* filename) {
+#define MIN_GAME_FILE_SIZE (g_N*g_N)
+#define GAME_FILE_BUFFER_SIZE (MIN_GAME_FILE_SIZE + 100)
+
+// Read the game into the caller's buffer (which is NUL terminated)
+static int readGameFile (const char* filename, char buffer[GAME_FILE_BUFFER_SIZE]) {
 	int fd = open(filename, O_RDONLY);
 	if (fd < 0) {
 		TRACE(0, "Error: unable to open \"%s\"\n", filename);
-		return NULL;
+		return -1;
 	}
 
-	#define MIN_GAME_FILE_SIZE (g_N*g_N)
-	static char buffer[MIN_GAME_FILE_SIZE + 100];
-	ssize_t readLen = read(fd, buffer, sizeof(buffer));
+	ssize_t readLen = read(fd, buffer, GAME_FILE_BUFFER_SIZE - 1);
 	close(fd);
 
 	if (readLen < MIN_GAME_FILE_SIZE) {
 		TRACE(0, "Error: file not big enough (%ld)\n", readLen);
-		return NULL;
+		return -1;
 	}
 
-	return buffer;
+	buffer[readLen] = '\0';
+
+	return 0;
 }
 
 int SudokuSolver::loadGameFile (const char* filename) {
-	char* buffer = readGameFile(filename);
+	char buffer[GAME_FILE_BUFFER_SIZE];
 
-	return buffer ? loadGameString(buffer) : -1;
+	return (readGameFile(filename, buffer) == 0) ? loadGameString(buffer) : -1;
 }
 
 int SudokuSolver::checkGameFile (const char* filename) {
-	char* buffer = readGameFile(filename);
+	char buffer[GAME_FILE_BUFFER_SIZE];
 
-	return buffer ? checkGameString(buffer) : -1;
+	return (readGameFile(filename, buffer) == 0) ? checkGameString(buffer) : -1;
 }
 
 void SudokuSolver::reset () {
-	ForEachInCellSetCollectionArray(m_cellSetCollections, cellSetCollection) {
-		cellSetCollection->reset();
+	// n.b., the same as resetting each of the collections, without visiting every cell 3 times
+	ForEachInObjectArray(PossibleValues, m_grid.m_cells, possibleValues) {
+		possibleValues->reset();
+	}
+
+	ForEachInObjectArray(PossibleValues, m_grid.m_cellSets, cellSetPossibleValues) {
+		cellSetPossibleValues->reset();
+	}
+
+	for (int unit=0; unit<BoardTopology::NUM_UNITS; unit++) {
+		for (int value=0; value<g_N; value++) {
+			m_grid.m_locations[unit][value] = ALL_LOCATIONS;
+		}
 	}
+
+	for (int value=0; value<g_N; value++) {
+		m_grid.m_bivalueCells[value].reset();
+	}
+	m_grid.m_trivalueCells.reset();
+
+	m_searchDepth = 0;
+	m_numSearchNodes = 0;
+
+	m_currentAlgorithm = NUM_ALGORITHMS;
+
+	m_propagationStats.reset();
+	m_solverStats.reset();
+	queueEverything();
+	setEverythingDirty();
+
+	memset(m_clues, -1, sizeof(m_clues));
+	m_clueGrid = m_grid;
+	m_hasGuesses = false;
 }
 
 bool SudokuSolver::checkForNakedSubsets (int n) {
@@ -1394,168 +1396,228 @@ bool SudokuSolver::checkForHiddenSubsets (int n) {
 	return anyReductions;
 }
 
+// Locked candidates, over the 54 places where a box crosses a row/col (an "intersection"):
+// 1) pointing: if a value is only possible in the intersection as far as the box is concerned,
+//    then it can't be anywhere else in the row/col, and
+// 2) claiming: if it's only possible in the intersection as far as the row/col is concerned,
+//    then it can't be anywhere else in the box.
+// Both come out of the same few mask operations per value.
 bool SudokuSolver::checkForLockedCandidates () {
 	TRACE(3, "%s()\n", __CLASSFUNCTION__);
 
+	// Only the intersections of rows/cols/boxes that changed since the last time can have anything new
+	bool needsScan[BoardTopology::NUM_UNITS];
+	for (int unit=0; unit<BoardTopology::NUM_UNITS; unit++) {
+		needsScan[unit] = getCellSet(unit)->needsScan();
+	}
+
 	bool anyReductions = false;
 
-	ForEachInCellSetCollectionArray(m_cellSetCollections, cellSetCollection) {
-		anyReductions |= cellSetCollection->checkForLockedCandidates();
+	for (int i=0; i<BoardTopology::NUM_INTERSECTIONS; i++) {
+		const BoardTopology::Intersection* intersection = &g_topology.m_intersections[i];
+
+		if (!needsScan[intersection->m_box] && !needsScan[intersection->m_line]) {
+			continue;
+		}
+
+		CellSet* box = getCellSet(intersection->m_box);
+		CellSet* line = getCellSet(intersection->m_line);
+
+		LocationMask boxLocations = intersection->m_boxLocations;
+		LocationMask lineLocations = intersection->m_lineLocations;
+
+		for (int candidate=0; candidate<g_N; candidate++) {
+			LocationMask inBox = m_grid.m_locations[intersection->m_box][candidate];
+			LocationMask inLine = m_grid.m_locations[intersection->m_line][candidate];
+
+			// n.b., nothing to do unless it's possible in the intersection (and somewhere else)
+			if (!(inBox & boxLocations)) {
+				continue;
+			}
+
+			LocationMask restOfBox = inBox & ~boxLocations;
+			LocationMask restOfLine = inLine & ~lineLocations;
+
+			if (!restOfBox && restOfLine) {
+				TRACE(2, "%s() %d is pointing from %s to %s\n",
+					__CLASSFUNCTION__, candidate+1, box->getName().c_str(), line->getName().c_str());
+
+				anyReductions |= line->tryToReduceLocations(candidate, restOfLine);
+			} else if (!restOfLine && restOfBox) {
+				TRACE(2, "%s() %d is claimed from %s by %s\n",
+					__CLASSFUNCTION__, candidate+1, box->getName().c_str(), line->getName().c_str());
+
+				anyReductions |= box->tryToReduceLocations(candidate, restOfBox);
+			}
+		}
 	}
 
 	return anyReductions;
 }
 
-bool SudokuSolver::checkForXWings (int n) {
+bool SudokuSolver::checkForFish (int n) {
 	TRACE(3, "%s(n=%d)\n", __CLASSFUNCTION__, n);
 
 	bool anyReductions = false;
 
 	for (int candidate=0; candidate<g_N; candidate++) {
-		anyReductions |= m_allRows.checkForXWings(n, candidate);
-		anyReductions |= m_allCols.checkForXWings(n, candidate);
+		if (!needsDigitScan(candidate)) {
+			continue;
+		}
+
+		anyReductions |= m_allRows.checkForFish(n, candidate);
+		anyReductions |= m_allCols.checkForFish(n, candidate);
 	}
 
 	return anyReductions;
 }
 
-bool SudokuSolver::checkForYWings () {
+// Finned (and sashimi) X-wings, swordfish and jellyfish
+bool SudokuSolver::checkForFinnedFish () {
 	TRACE(3, "%s()\n", __CLASSFUNCTION__);
 
-	return m_allCells.checkForYWings();
-}
+	bool anyReductions = false;
 
-void Cell::resetChain () {
-	m_chainStatus = CHAIN_STATUS_UNCOLORED;
-}
+	for (int candidate=0; candidate<g_N; candidate++) {
+		if (!needsDigitScan(candidate)) {
+			continue;
+		}
 
-void AllCells::resetChains () {
-	ForEachInCellArray(m_cells, cell) {
-		cell->resetChain();
+		for (int n=2; n<=4; n++) {
+			anyReductions |= m_allRows.checkForFish(n, candidate, true);
+			anyReductions |= m_allCols.checkForFish(n, candidate, true);
+		}
 	}
-}
 
-int CellSet::getNumPossible (int candidate) {
-	TRACE(3, "%s(this=%s, candidate=%d)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1);
+	return anyReductions;
+}
 
-	int numPossible = 0;
+bool SudokuSolver::checkForYWings () {
+	TRACE(3, "%s()\n", __CLASSFUNCTION__);
 
-	ForEachInCellArray(m_cells, cell) {
-		if (cell->isPossible(candidate)) {
-			numPossible++;
-		}
+	if (!needsBoardScan()) {
+		return false;
 	}
 
-	TRACE(4, "%s(this=%s, candidate=%d) numPossible=%d\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, numPossible);
-
-	return numPossible;
-}
+	// n.b., every bivalue cell is in two of the sets
+	CellMask pivots = getBivalueCells(0);
+	for (int value=1; value<g_N; value++) {
+		pivots = pivots | getBivalueCells(value);
+	}
 
-bool Cell::isConjugatePair (int candidate) {
-	TRACE(3, "%s(this=%s, candidate=%d)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1);
+	bool anyReductions = false;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		int numPossible = cellSet->getNumPossible(candidate);
-		if (numPossible == 2) {
-TRACE(2, "%s(this=%s, candidate=%d) is conjugate pair in %s\n", __CLASSFUNCTION__, m_name.c_str(), candidate+1, cellSet->getName().c_str());
-			return true;
-		}
+	while (!pivots.isEmpty()) {
+		anyReductions |= getCell(pivots.removeFirst())->checkForYWings();
 	}
 
-	return false;
+	return anyReductions;
 }
 
-bool Cell::buildChains (int candidate, ChainStatusType chainStatus, Cell* linkingCell) {
-	TRACE(4, "%s(this=%s, candidate=%d, chainStatus=%s, linkingCell=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, chainStatusToString(chainStatus),
-		linkingCell ? linkingCell->getName().c_str() : "NULL");
+// Color one singles chain, breadth first from firstCell: each cell's conjugate pairs (the other cell
+// in a row/col/box where "candidate" is only possible twice) get the opposite color.
+// The cells that get colored are taken out of unchainedCells.
+void SudokuSolver::buildSinglesChain (int candidate, int firstCell, CellMask* unchainedCells, SinglesChain* chain) {
+	memset(chain, 0, sizeof(*chain));
 
-	// If this cell has already been colored, bail
-	if (m_chainStatus != CHAIN_STATUS_UNCOLORED) {
-		return false;
-	}
+	int queue[g_N * g_N];
+	int queueLength = 0;
 
-	// If this cell does not have candidate for a possible value, then bail
-	if (!isPossible(candidate)) {
-		return false;
-	}
+	unchainedCells->clear(firstCell);
+	chain->m_cells[CHAIN_COLOR_RED].set(firstCell);
+	queue[queueLength++] = firstCell;
 
-	// Is this cell part of a conjugate pair?
-	if (!isConjugatePair(candidate)) {
-		return false;
-	}
+	for (int i=0; i<queueLength; i++) {
+		int cell = queue[i];
+		int color = chain->m_cells[CHAIN_COLOR_RED].has(cell) ? CHAIN_COLOR_RED : CHAIN_COLOR_BLACK;
+		int otherColor = (color == CHAIN_COLOR_RED) ? CHAIN_COLOR_BLACK : CHAIN_COLOR_RED;
 
-	// Set this cell's status
-	m_chainStatus = chainStatus;
+		TRACE(3, "%s(candidate=%d) %s is %s\n",
+			__CLASSFUNCTION__, candidate+1, getCell(cell)->getName().c_str(), chainColorToString((ChainColorType)color));
 
-	TRACE(3, "%s(this=%s, candidate=%d, chainStatus=%s, linkingCell=%s) %s=%s\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, chainStatusToString(chainStatus),
-		linkingCell ? linkingCell->getName().c_str() : "NULL",
-		m_name.c_str(), chainStatusToString(chainStatus));
+		for (int collection=0; collection<NUM_COLLECTIONS; collection++) {
+			int unit = g_topology.m_cellUnits[cell][collection];
+			LocationMask positionBit = (1 << g_topology.m_cellPositions[cell][collection]);
 
-	ChainStatusType nextStatus = (chainStatus == CHAIN_STATUS_COLOR_RED) ?
-		CHAIN_STATUS_COLOR_BLACK :
-		CHAIN_STATUS_COLOR_RED;
+			chain->m_locations[color][unit] |= positionBit;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		cellSet->buildChains(candidate, nextStatus, this);
-	}
+			LocationMask locations = m_grid.m_locations[unit][candidate];
+			if (countCandidates(locations) != 2) {
+				continue;
+			}
 
-	return true;
+			int otherCell = g_topology.m_unitCells[unit][firstCandidate(locations & ~positionBit)];
+			if (unchainedCells->has(otherCell)) {
+				unchainedCells->clear(otherCell);
+				chain->m_cells[otherColor].set(otherCell);
+				queue[queueLength++] = otherCell;
+			}
+		}
+	}
 }
 
-void CellSet::buildChains (int candidate, ChainStatusType chainStatus, Cell* linkingCell) {
-	TRACE(4, "%s(this=%s, candidate=%d, chainStatus=%s, linkingCell=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, chainStatusToString(chainStatus), linkingCell->getName().c_str());
+// Either all of the red cells or all of the black cells in a chain are "candidate", so:
+//	1) if two cells of the same color are in the same row/col/box, then none of that color can be, and
+//	2) otherwise, any cell that can see both colors can't be
+bool SudokuSolver::checkForSinglesChainsReductions (int candidate, SinglesChain* chain, const CellMask& cellsWithCandidate) {
+	bool anyReductions = false;
 
-	// Are there only 2 possible cells for this candidate?
-	// If so, then there is a chain!
-	if (getNumPossible(candidate) != 2) {
-		return;
-	}
+	for (int color=0; color<NUM_CHAIN_COLORS; color++) {
+		for (int unit=0; unit<BoardTopology::NUM_UNITS; unit++) {
+			if (countCandidates(chain->m_locations[color][unit]) < 2) {
+				continue;
+			}
 
-	TRACE(3, "%s(this=%s, candidate=%d, chainStatus=%s, linkingCell=%s)\n",
-		__CLASSFUNCTION__, m_name.c_str(), candidate+1, chainStatusToString(chainStatus), linkingCell->getName().c_str());
+			TRACE(2, "%s(candidate=%d) two %s cells in %s\n", __CLASSFUNCTION__, candidate+1,
+				chainColorToString((ChainColorType)color), getCellSet(unit)->getName().c_str());
 
-	ForEachInCellArray(m_cells, cell) {
-		cell->buildChains(candidate, chainStatus, linkingCell);
+			CellMask cells = chain->m_cells[color];
+			while (!cells.isEmpty()) {
+				Cell* cell = getCell(cells.removeFirst());
+				anyReductions |= cell->tryToReduce(candidate, cell->getCurrentAlgorithm());
+			}
+
+			break;
+		}
+	}
+
+	if (anyReductions) {
+		return true;
 	}
-}
 
+	// Which cells can see each color?
+	CellMask canSee[NUM_CHAIN_COLORS];
+	for (int color=0; color<NUM_CHAIN_COLORS; color++) {
+		canSee[color].reset();
 
-// return true if any of the cells in this CellSet have the specified chainStatus
-bool CellSet::checkChainStatus (ChainStatusType chainStatus) {
-	ForEachInCellArray(m_cells, cell) {
-		if (cell->getChainStatus() == chainStatus) {
-			return true;
+		CellMask cells = chain->m_cells[color];
+		while (!cells.isEmpty()) {
+			canSee[color] = canSee[color] | CellMask::peersOf(cells.removeFirst());
 		}
 	}
 
-	return false;
-}
-
-// return true if this (uncolored) cell can see a cell of the specified chainStatus
-bool Cell::canSee (ChainStatusType chainStatus) {
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		if (cellSet->checkChainStatus(chainStatus)) {
-			return true;
+	CellMask cells = canSee[CHAIN_COLOR_RED] & canSee[CHAIN_COLOR_BLACK] & cellsWithCandidate;
+	while (!cells.isEmpty()) {
+		int index = cells.removeFirst();
+		if (chain->m_cells[CHAIN_COLOR_RED].has(index) || chain->m_cells[CHAIN_COLOR_BLACK].has(index)) {
+			continue;
 		}
+
+		Cell* cell = getCell(index);
+		anyReductions |= cell->tryToReduce(candidate, cell->getCurrentAlgorithm());
 	}
 
-	return false;
+	return anyReductions;
 }
 
-void SudokuSolver::printColors () {
+void SudokuSolver::printColors (SinglesChain* chain) {
 	for (int row=0; row<g_N; row++) {
 		for (int col=0; col<g_N; col++) {
-			Cell* cell = m_allCells.getCell(row, col);
+			int index = (row * g_N) + col;
 
-			if (cell->getChainStatus() == CHAIN_STATUS_COLOR_RED) {
+			if (chain->m_cells[CHAIN_COLOR_RED].has(index)) {
 				printf("r");
-			} else if (cell->getChainStatus() == CHAIN_STATUS_COLOR_BLACK) {
+			} else if (chain->m_cells[CHAIN_COLOR_BLACK].has(index)) {
 				printf("b");
 			} else {
 				printf("-");
@@ -1566,290 +1628,299 @@ void SudokuSolver::printColors () {
 	printf("\n");
 }
 
-// Any cells with a matching chainStatus can have "candidate" removed
-bool SudokuSolver::singlesChainsReduction (int candidate, ChainStatusType chainStatus) {
-	TRACE(3, "%s(candidate=%d, chainStatus=%s)\n",
-		__CLASSFUNCTION__, candidate+1, chainStatusToString(chainStatus));
+// Singles chains (simple coloring):
+// Where "candidate" is only possible in 2 cells of a row/col/box (a "conjugate pair"), one of them has to be it.
+// Conjugate pairs that share cells link up into chains, which are colored alternately red and black.
+// The links come straight from the location masks, and each chain is colored (once) without any recursion.
+bool SudokuSolver::checkForSinglesChains (int candidate) {
+	TRACE(3, "%s(candidate=%d)\n", __CLASSFUNCTION__, candidate+1);
+
+	// Which cells could be "candidate", and which of them are in a conjugate pair?
+	CellMask cellsWithCandidate;
+	CellMask unchainedCells;
+	cellsWithCandidate.reset();
+	unchainedCells.reset();
 
-	bool anyReductions = false;
+	for (int unit=0; unit<BoardTopology::NUM_UNITS; unit++) {
+		LocationMask locations = m_grid.m_locations[unit][candidate];
+		int numLocations = countCandidates(locations);
 
-	for (int row=0; row<g_N; row++) {
-		for (int col=0; col<g_N; col++) {
-			Cell* cell = m_allCells.getCell(row, col);
+		if ((unit < g_N) || (numLocations == 2)) {
+			ForEachCandidate(locations, location) {
+				int cell = g_topology.m_unitCells[unit][location];
 
-			if (cell->getChainStatus() != chainStatus) {
-				continue;
+				if (unit < g_N) {
+					cellsWithCandidate.set(cell);
+				}
+				if (numLocations == 2) {
+					unchainedCells.set(cell);
+				}
 			}
+		}
+	}
+
+	bool anyReductions = false;
 
-			TRACE(3, "%s(candidate=%d, chainStatus=%s) checking %s\n",
-				__CLASSFUNCTION__, candidate+1, chainStatusToString(chainStatus), cell->getName().c_str());
+	while (!unchainedCells.isEmpty()) {
+		SinglesChain chain;
+		buildSinglesChain(candidate, unchainedCells.removeFirst(), &unchainedCells, &chain);
 
-			anyReductions |= cell->tryToReduce(candidate, g_currentAlgorithm);
+		if (checkForSinglesChainsReductions(candidate, &chain, cellsWithCandidate)) {
+			if (g_debugLevel > 1) {
+				printColors(&chain);
+			}
+
+			anyReductions = true;
 		}
 	}
 
 	return anyReductions;
 }
 
-// How many cells in this CellSet have the specified chainStatus?
-int CellSet::getChainStatusCount (ChainStatusType chainStatus) {
-	int count = 0;
+bool SudokuSolver::checkForSinglesChains () {
+	TRACE(3, "%s()\n", __CLASSFUNCTION__);
+
+	bool anyReductions = false;
 
-	ForEachInCellArray(m_cells, cell) {
-		if (cell->getChainStatus() == chainStatus) {
-			count++;
+	for (int candidate=0; candidate<g_N; candidate++) {
+		if (!needsDigitScan(candidate)) {
+			continue;
 		}
+
+		anyReductions |= checkForSinglesChains(candidate);
 	}
 
-	return count;
+	return anyReductions;
 }
 
-// return true if two cells in this CellSet have the specified chainStatus
-bool CellSetCollection::checkForTwoOfTheSameColor (ChainStatusType chainStatus) {
-	TRACE(3, "%s(this=%s, chainStatus=%s)\n", __CLASSFUNCTION__, m_name.c_str(), chainStatusToString(chainStatus));
+// One of the candidates node1 and node2 has to be true.
+// So any candidate that can't be true alongside either of them can't be true at all.
+bool SudokuSolver::chainReduction (int node1, int node2) {
+	int cellIndex1 = ImplicationGraph::getCell(node1);
+	int cellIndex2 = ImplicationGraph::getCell(node2);
+	int value1 = ImplicationGraph::getValue(node1);
+	int value2 = ImplicationGraph::getValue(node2);
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		int chainStatusCount = cellSet->getChainStatusCount(chainStatus);
-
-		TRACE(3, "%s(this=%s, chainStatus=%s) %s count=%d\n",
-			__CLASSFUNCTION__, m_name.c_str(), chainStatusToString(chainStatus), cellSet->getName().c_str(), chainStatusCount);
-
-		if (chainStatusCount == 2) {
-			return true;
-		}
-	}
+	Cell* cell1 = getCell(cellIndex1);
+	Cell* cell2 = getCell(cellIndex2);
 
-	return false;
-}
-
-bool SudokuSolver::checkForSinglesChainsReductions_SameColor (int candidate, ChainStatusType chainStatus) {
-	TRACE(2, "%s(candidate=%d, chainStatus=%s)\n", __CLASSFUNCTION__, candidate+1, chainStatusToString(chainStatus));
+	// The same cell: it can only be one of the two values (or just the one, when they're the same)
+	if (cellIndex1 == cellIndex2) {
+		CandidateMask values = CandidateBit(value1) | CandidateBit(value2);
 
-	ForEachInCellSetCollectionArray(m_cellSetCollections, cellSetCollection) {
-		if (cellSetCollection->checkForTwoOfTheSameColor(chainStatus)) {
-			return singlesChainsReduction(candidate, chainStatus);
-		}
+		return cell1->tryToReduceCandidates(cell1->getPossibleMask() & ~values, cell1->getCurrentAlgorithm());
 	}
 
-	return false;
-}
-
-// If any uncolored cells can see cells of different colors, then the specified
-// candidate is no longer possible
-bool SudokuSolver::checkForSinglesChainsReductions_DifferentColors (int candidate) {
-	TRACE(3, "%s(candidate=%d)\n", __CLASSFUNCTION__, candidate+1);
-
 	bool anyReductions = false;
 
-	for (int row=0; row<g_N; row++) {
-		for (int col=0; col<g_N; col++) {
-			Cell* cell = m_allCells.getCell(row, col);
-
-			if (cell->getChainStatus() != CHAIN_STATUS_UNCOLORED) {
-				continue;
-			}
-
-			// If this uncolored cell can see two cells with different colors, then it can't be "candidate"
-			if (cell->canSee(CHAIN_STATUS_COLOR_RED) && cell->canSee(CHAIN_STATUS_COLOR_BLACK)) {
-				anyReductions |= cell->tryToReduce(candidate, g_currentAlgorithm);
-			}
+	if (value1 == value2) {
+		// The same value: it can't be in any cell that sees both of them
+		CellMask cells = CellMask::peersOf(cellIndex1) & CellMask::peersOf(cellIndex2);
+		while (!cells.isEmpty()) {
+			Cell* cell = getCell(cells.removeFirst());
+			anyReductions |= cell->tryToReduce(value1, cell->getCurrentAlgorithm());
 		}
+	} else if (g_topology.isPeer(cellIndex1, cellIndex2)) {
+		// Different values in cells that see each other: neither cell can be the other's value
+		anyReductions |= cell1->tryToReduce(value2, cell1->getCurrentAlgorithm());
+		anyReductions |= cell2->tryToReduce(value1, cell2->getCurrentAlgorithm());
 	}
 
 	return anyReductions;
 }
 
-bool SudokuSolver::checkForSinglesChains (int candidate) {
-	TRACE(3, "%s(candidate=%d)\n", __CLASSFUNCTION__, candidate+1);
-
-	m_allCells.resetChains();
-
-	bool anyReductions = false;
-
-	for (int row=0; row<g_N; row++) {
-		for (int col=0; col<g_N; col++) {
-			Cell* cell = m_allCells.getCell(row, col);
-
-			if (cell->buildChains(candidate, CHAIN_STATUS_COLOR_RED, NULL)) {
-				bool status = false;
-
-				// Do any of the CellSet's have two of the same color?
-				status |= checkForSinglesChainsReductions_SameColor(candidate, CHAIN_STATUS_COLOR_RED);
-				status |= checkForSinglesChainsReductions_SameColor(candidate, CHAIN_STATUS_COLOR_BLACK);
-
-				// If not, check for any cells that see two cells of different colors
-				if (!status) {
-					status = checkForSinglesChainsReductions_DifferentColors(candidate);
-				}
-
-				if (status) {
-					if (g_debugLevel > 1) {
-						printColors();
-					}
-					anyReductions = true;
-				}
+// Chains: assume a candidate is false, and see what has to be true (see ImplicationGraph).
+// Each kind of chain is made of different links:
+// 1) X-cycles: one value, strong links between the only 2 cells of a row/col/box that could be it
+//    (weak links between any two cells that see each other),
+// 2) XY-chains: bivalue cells (strong inside the cell, weak between cells with the same value),
+// 3) AICs: any of them.
+// Stop at the first chain that eliminates anything, so the simpler algorithms get another look.
+bool SudokuSolver::checkForChains (AlgorithmType algorithm) {
+	TRACE(3, "%s(algorithm=%s)\n", __CLASSFUNCTION__, algorithmToString(algorithm));
 
-				m_allCells.resetChains();
+	int linkTypes =
+		(algorithm == ALG_CHECK_FOR_X_CYCLES) ? LINK_TYPE_BIT(LINK_STRONG_UNIT) | LINK_TYPE_BIT(LINK_WEAK_UNIT) :
+		(algorithm == ALG_CHECK_FOR_XY_CHAINS) ? LINK_TYPE_BIT(LINK_STRONG_CELL) | LINK_TYPE_BIT(LINK_WEAK_UNIT) :
+		ALL_LINK_TYPES;
+
+	// X-cycles only follow one value's links, so only the values that changed since the last scan can have
+	// new ones. The other chains can't skip anything: e.g., taking one value out of a cell can leave it
+	// bivalue, which is a new strong link for the other value, even though that one didn't change.
+	CandidateMask values = 0;
+	if (algorithm == ALG_CHECK_FOR_X_CYCLES) {
+		for (int value=0; value<g_N; value++) {
+			if (needsDigitScan(value)) {
+				values |= CandidateBit(value);
 			}
 		}
+	} else if (needsBoardScan()) {
+		values = ALL_CANDIDATES;
 	}
 
-	return anyReductions;
-}
-
-bool SudokuSolver::checkForSinglesChains () {
-	TRACE(3, "%s()\n", __CLASSFUNCTION__);
-
-	bool anyReductions = false;
-
-	for (int candidate=0; candidate<g_N; candidate++) {
-		anyReductions |= checkForSinglesChains(candidate);
-	}
-
-	return anyReductions;
-}
-
-bool Cell::checkForXYZWings (Cell* cell2) {
-	TRACE(3, "%s(this=%s, cell2=%s)\n", __CLASSFUNCTION__, m_name.c_str(), cell2->getName().c_str());
-
-	Cell* cell1 = this;
-
-	IntList* cell1PossibleValues = cell1->getPossibleValuesList();
-	IntList* cell2PossibleValues = cell2->getPossibleValuesList();
-
-	if (cell2PossibleValues->getLength() != 2) {
+	if (!values) {
 		return false;
 	}
 
-	// Make sure the two values of the second cell match two of the three values of the first cell
-	IntList intersection12 = IntList::findIntersection(*cell1PossibleValues, *cell2PossibleValues);
-	if (intersection12.getLength() != 2) {
-		return false;
+	if (!m_implicationGraph) {
+		m_implicationGraph = new ImplicationGraph();
 	}
 
-	bool anyReductions = false;
+	ImplicationGraph* graph = m_implicationGraph;
+	graph->build(&m_grid);
 
-	// Try to find a third cell that:
-	// 1) is visible by the cell1,
-	// 2) not visible by the cell2,
-	// 3) has two possible values, both in common with cell1 and one in common with cell2
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		ForEachInCellArray(cellSet->m_cells, cell3) {
-			if ((cell3 == cell1) || (cell3 == cell2)) {
+	for (int cell=0; cell<g_N*g_N; cell++) {
+		ForEachCandidate(m_grid.m_cells[cell].getMask() & values, value) {
+			int node = ImplicationGraph::getNode(cell, value);
+			if (!graph->hasLinks(node, linkTypes & STRONG_LINK_TYPES)) {
 				continue;
 			}
 
-			IntList* cell3PossibleValues = cell3->getPossibleValuesList();
-
-			TRACE(3, "%s(this=%s(%s)) cell2=%s(%s), cell3=%s(%s)\n", __CLASSFUNCTION__,
-				cell1->getName().c_str(), cell1PossibleValues->toString(),
-				cell2->getName().c_str(), cell2PossibleValues->toString(),
-				cell3->getName().c_str(), cell3PossibleValues->toString());
-
-			// Make sure cell2 can't see cell3
-			if (cell2->hasNeighbor(cell3)) {
+			int end = graph->search(node, linkTypes, MAX_CHAIN_LENGTH);
+			if (end < 0) {
 				continue;
 			}
 
-			if (cell3PossibleValues->getLength() != 2) {
-				continue;
-			}
+			TRACE(2, "%s(algorithm=%s) %s\n", __CLASSFUNCTION__, algorithmToString(algorithm),
+				graph->getChainString(end).c_str());
 
-			// Make sure the two values of the third cell match two of the three values of the first cell
-			IntList intersection13 = IntList::findIntersection(*cell1PossibleValues, *cell3PossibleValues);
-			if (intersection13.getLength() != 2) {
-				continue;
-			}
+			if (chainReduction(node, end)) {
+				// n.b., the scan was cut short, so it isn't clean
+				m_cleanValues[m_currentAlgorithm] = 0;
 
-			// intersection12 and interesection13 CAN'T be the same
-			IntList intersection12_13 = IntList::findIntersection(intersection12, intersection13);
-			if (intersection12_13.getLength() != 1) {
-				continue;
+				return true;
 			}
-
-			int candidate = intersection12_13.getValue(0);
-
-			anyReductions |= checkForXYZReductions(candidate, cell2, cell3);		
 		}
 	}
 
-	return anyReductions;
+	return false;
 }
 
 // return true if "candidate" is possible for any neighboring cells of all 3 cells (that aren't any of those cells)
 bool Cell::checkForXYZReductions (int candidate, Cell* cell2, Cell* cell3) {
-	Cell* cell1 = this;
-
 	bool anyReductions = false;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		ForEachInCellArray(cellSet->m_cells, cell) {
-			if ((cell == cell1) || (cell == cell2) || (cell == cell3)) {
-				continue;
-			}
+	const CellIndex* peers = g_topology.m_peers[getIndex()];
+	for (int i=0; i<BoardTopology::NUM_PEERS; i++) {
+		Cell* cell = m_solver->getCell(peers[i]);
 
-			if (!cell2->hasNeighbor(cell) || !cell3->hasNeighbor(cell)) {
-				continue;
-			}
+		if ((cell == cell2) || (cell == cell3)) {
+			continue;
+		}
 
-			anyReductions |= cell->tryToReduce(candidate, g_currentAlgorithm);
+		if (!cell2->hasNeighbor(cell) || !cell3->hasNeighbor(cell)) {
+			continue;
 		}
+
+		anyReductions |= cell->tryToReduce(candidate, cell->getCurrentAlgorithm());
 	}
 
 	return anyReductions;
 }
 
+// XYZ-Wing rule:
+// When this cell (the "pivot") has 3 possible values {x,y,z}, and it can see a cell with {x,z}
+// and a cell with {y,z} (the "pincers", which can't see each other), then one of the three
+// has to be "z". So "z" can be eliminated from every cell that can see all three.
+// n.b., the pincers come straight from the solver's index of bivalue cells
 bool Cell::checkForXYZWings () {
-	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, m_name.c_str());
+	TRACE(3, "%s(this=%s)\n", __CLASSFUNCTION__, getName().c_str());
 
-	IntList* possibleValuesList = m_possibleValues.getList();
+	CandidateMask possibleValues = getPossibleMask();
 
 	// Make sure this cell has 3 possible values
-	if (possibleValuesList->size() != 3) {
+	if (countCandidates(possibleValues) != 3) {
 		return false;
 	}
 
-	TRACE(3, "%s(this=%s) has 3 possible values: %s\n",
-		__CLASSFUNCTION__, m_name.c_str(), possibleValuesList->toString());
+	CellMask peers = CellMask::peersOf(getIndex());
 
 	bool anyReductions = false;
 
-	ForEachInCellSetArray(m_cellSets, cellSet) {
-		ForEachInCellArray(cellSet->m_cells, cell2) {
-			if (cell2 == this) {
-				continue;
-			}
+	ForEachCandidate(possibleValues, z) {
+		CandidateMask xy = possibleValues & ~CandidateBit(z);
+		int x = firstCandidate(xy);
+		int y = firstCandidate(xy & ~CandidateBit(x));
+
+		CellMask peersWithZ = peers & m_solver->getBivalueCells(z);
+		CellMask xzPincers = peersWithZ & m_solver->getBivalueCells(x);
+		if (xzPincers.isEmpty()) {
+			continue;
+		}
 
-			anyReductions |= checkForXYZWings(cell2);
+		CellMask yzPincers = peersWithZ & m_solver->getBivalueCells(y);
+
+		while (!xzPincers.isEmpty()) {
+			Cell* cell2 = m_solver->getCell(xzPincers.removeFirst());
+
+			CellMask cell3s = yzPincers;
+			while (!cell3s.isEmpty()) {
+				Cell* cell3 = m_solver->getCell(cell3s.removeFirst());
+
+				// Make sure cell2 can't see cell3
+				if (cell2->hasNeighbor(cell3)) {
+					continue;
+				}
+
+				TRACE(3, "%s(this=%s(%s)) cell2=%s(%s), cell3=%s(%s)\n", __CLASSFUNCTION__,
+					getName().c_str(), candidatesToString(possibleValues).c_str(),
+					cell2->getName().c_str(), candidatesToString(cell2->getPossibleMask()).c_str(),
+					cell3->getName().c_str(), candidatesToString(cell3->getPossibleMask()).c_str());
+
+				anyReductions |= checkForXYZReductions(z, cell2, cell3);
+			}
 		}
 	}
 
 	return anyReductions;
 }
 
-bool AllCells::checkForXYZWings () {
+bool SudokuSolver::checkForXYZWings () {
 	TRACE(3, "%s()\n", __CLASSFUNCTION__);
 
+	if (!needsBoardScan()) {
+		return false;
+	}
+
 	bool anyReductions = false;
 
-	ForEachInCellArray(m_cells, cell) {
-		anyReductions |= cell->checkForXYZWings();
+	CellMask pivots = getTrivalueCells();
+	while (!pivots.isEmpty()) {
+		anyReductions |= getCell(pivots.removeFirst())->checkForXYZWings();
 	}
 
 	return anyReductions;
 }
 
-bool SudokuSolver::checkForXYZWings () {
-	TRACE(3, "%s()\n", __CLASSFUNCTION__);
+bool SudokuSolver::runAlgorithm (AlgorithmType algorithm) {
+	TRACE(3, "%s(algorithm=%s)\n", __CLASSFUNCTION__, algorithmToString(algorithm));
+
+	uint64_t startTime = getTimeInNanoseconds();
 
-	return m_allCells.checkForXYZWings();
+	m_currentAlgorithm = algorithm;
+
+	bool anyReductions = runAlgorithmInternal(algorithm);
+
+	algorithmFinished(algorithm, anyReductions, startTime);
+
+	return anyReductions;
 }
 
-bool SudokuSolver::runAlgorithm (AlgorithmType algorithm) {
-	TRACE(3, "%s(algorithm=%s)\n", __CLASSFUNCTION__, algorithmToString(algorithm));
+// Charge an algorithm for one invocation
+void SudokuSolver::algorithmFinished (AlgorithmType algorithm, bool success, uint64_t startTime) {
+	AlgorithmStats* stats = &m_solverStats.m_algorithms[algorithm];
+
+	stats->m_numInvocations++;
+	if (success) {
+		stats->m_numSuccesses++;
+	}
+	stats->m_numNanoseconds += getTimeInNanoseconds() - startTime;
 
-	g_currentAlgorithm = algorithm;
+	// anything changed from here on (until the next algorithm runs) isn't this algorithm's doing
+	m_currentAlgorithm = NUM_ALGORITHMS;
+}
 
+bool SudokuSolver::runAlgorithmInternal (AlgorithmType algorithm) {
 	switch (algorithm) {
 		case ALG_CHECK_FOR_NAKED_SINGLES:
 			return checkForNakedSubsets(1);
@@ -1873,7 +1944,7 @@ bool SudokuSolver::runAlgorithm (AlgorithmType algorithm) {
 			return checkForHiddenSubsets(3);
 
 		case ALG_CHECK_FOR_XWINGS:
-			return checkForXWings(2);
+			return checkForFish(2);
 
 		case ALG_CHECK_FOR_YWINGS:
 			return checkForYWings();
@@ -1882,7 +1953,7 @@ bool SudokuSolver::runAlgorithm (AlgorithmType algorithm) {
 			return checkForSinglesChains();
 
 		case ALG_CHECK_FOR_SWORDFISH:
-			return checkForXWings(3);
+			return checkForFish(3);
 
 		case ALG_CHECK_FOR_NAKED_QUADS:
 			return checkForNakedSubsets(4);
@@ -1893,6 +1964,17 @@ bool SudokuSolver::runAlgorithm (AlgorithmType algorithm) {
 		case ALG_CHECK_FOR_XYZ_WINGS:
 			return checkForXYZWings();
 
+		case ALG_CHECK_FOR_JELLYFISH:
+			return checkForFish(4);
+
+		case ALG_CHECK_FOR_FINNED_FISH:
+			return checkForFinnedFish();
+
+		case ALG_CHECK_FOR_X_CYCLES:
+		case ALG_CHECK_FOR_XY_CHAINS:
+		case ALG_CHECK_FOR_AICS:
+			return checkForChains(algorithm);
+
 		default:
 			break;
 	}
@@ -1900,15 +1982,188 @@ bool SudokuSolver::runAlgorithm (AlgorithmType algorithm) {
 	return false;
 }
 
+void SudokuSolver::cellChanged (Cell* cell, CandidateMask changedValues) {
+	for (int alg=0; alg<NUM_ALGORITHMS; alg++) {
+		m_cleanValues[alg] &= ~changedValues;
+	}
+
+	int cellIndex = cell->getIndex();
+
+	m_grid.updateIndexes(cellIndex, changedValues);
+
+	// n.b., clues and guesses don't belong to any algorithm
+	if (m_currentAlgorithm < NUM_ALGORITHMS) {
+		AlgorithmStats* stats = &m_solverStats.m_algorithms[m_currentAlgorithm];
+
+		if (cell->getKnown()) {
+			stats->m_numPlacements++;
+		} else {
+			stats->m_numEliminations += countCandidates(changedValues);
+		}
+	}
+
+	if (!m_cellQueued[cellIndex] && !cell->getKnown()) {
+		m_cellQueued[cellIndex] = true;
+		m_cellQueue[m_cellQueueLength++] = cell;
+	}
+
+	for (int collection=0; collection<NUM_COLLECTIONS; collection++) {
+		CellSet* cellSet = cell->getCellSet((CollectionType)collection);
+		cellSet->setDirty();
+
+		int cellSetIndex = cellSet->getIndex();
+		if (!m_cellSetQueued[cellSetIndex]) {
+			m_cellSetQueued[cellSetIndex] = true;
+			m_cellSetQueue[m_cellSetQueueLength++] = cellSet;
+		}
+	}
+}
+
+// return false if the current algorithm has already scanned "value" and no "value" has been eliminated since.
+// Otherwise, mark it clean (any reductions made while scanning will dirty it again)
+bool SudokuSolver::needsDigitScan (int value) {
+	CandidateMask valueBit = CandidateBit(value);
+
+	if (m_cleanValues[m_currentAlgorithm] & valueBit) {
+		m_propagationStats.m_numCleanDigitsSkipped++;
+		return false;
+	}
+
+	m_cleanValues[m_currentAlgorithm] |= valueBit;
+
+	return true;
+}
+
+// Same as needsDigitScan() for algorithms that look at the whole board at once
+bool SudokuSolver::needsBoardScan () {
+	if (m_cleanValues[m_currentAlgorithm] == ALL_CANDIDATES) {
+		m_propagationStats.m_numCleanDigitsSkipped += g_N;
+		return false;
+	}
+
+	m_cleanValues[m_currentAlgorithm] = ALL_CANDIDATES;
+
+	return true;
+}
+
+void SudokuSolver::setEverythingDirty () {
+	memset(m_cleanValues, 0, sizeof(m_cleanValues));
+
+	for (int collection=0; collection<NUM_COLLECTIONS; collection++) {
+		for (int i=0; i<g_N; i++) {
+			m_cellSetCollections[collection]->getCellSet(i)->setDirty();
+		}
+	}
+}
+
+// n.b., just the queues: the indexes don't change
+void SudokuSolver::queueEverything () {
+	clearQueue();
+
+	for (int i=0; i<g_N*g_N; i++) {
+		Cell* cell = m_allCells.getCell(i);
+
+		if (!cell->getKnown()) {
+			m_cellQueued[i] = true;
+			m_cellQueue[m_cellQueueLength++] = cell;
+		}
+	}
+
+	for (int unit=0; unit<BoardTopology::NUM_UNITS; unit++) {
+		m_cellSetQueued[unit] = true;
+		m_cellSetQueue[m_cellSetQueueLength++] = getCellSet(unit);
+	}
+}
+
+void SudokuSolver::clearQueue () {
+	while (m_cellQueueLength > 0) {
+		m_cellQueued[m_cellQueue[--m_cellQueueLength]->getIndex()] = false;
+	}
+
+	while (m_cellSetQueueLength > 0) {
+		m_cellSetQueued[m_cellSetQueue[--m_cellSetQueueLength]->getIndex()] = false;
+	}
+}
+
+// Check the queued cells for naked singles, then the queued rows/cols/boxes for hidden singles.
+// Stop as soon as something is found (whatever it changes gets queued up).
+// return false once the queue is empty, i.e., there are no singles anywhere
+bool SudokuSolver::processQueue () {
+	uint64_t startTime = getTimeInNanoseconds();
+
+	while (m_cellQueueLength > 0) {
+		Cell* cell = m_cellQueue[--m_cellQueueLength];
+		m_cellQueued[cell->getIndex()] = false;
+
+		m_propagationStats.m_numCellChecks++;
+
+		if (!cell->getKnown() && (cell->getNumPossible() == 1)) {
+			m_currentAlgorithm = ALG_CHECK_FOR_NAKED_SINGLES;
+
+			bool anyReductions = cell->processNakedSingle();
+			algorithmFinished(ALG_CHECK_FOR_NAKED_SINGLES, anyReductions, startTime);
+
+			return anyReductions;
+		}
+	}
+
+	// The time spent checking cells is charged to hidden singles if there weren't any naked singles
+	bool anyReductions = false;
+
+	while (m_cellSetQueueLength > 0) {
+		CellSet* cellSet = m_cellSetQueue[--m_cellSetQueueLength];
+		m_cellSetQueued[cellSet->getIndex()] = false;
+
+		m_propagationStats.m_numUnitScans++;
+
+		m_currentAlgorithm = ALG_CHECK_FOR_HIDDEN_SINGLES;
+
+		if (cellSet->checkForHiddenSubsets(1)) {
+			anyReductions = true;
+			break;
+		}
+	}
+
+	algorithmFinished(ALG_CHECK_FOR_HIDDEN_SINGLES, anyReductions, startTime);
+
+	return anyReductions;
+}
+
 bool SudokuSolver::tryToSolve () {
 	TRACE(3, "%s()\n", __CLASSFUNCTION__);
 
-	// Try each of the various algorithms. Stop when one is successful.
-	for (int i=0; i<NUM_ALGORITHMS; i++) {
+	m_propagationStats.m_numSteps++;
+
+	// Only the cells and rows/cols/boxes that changed can have new singles
+	int numUnitScans = m_propagationStats.m_numUnitScans;
+	int numCellChecks = m_propagationStats.m_numCellChecks;
+
+	bool foundSingle = processQueue();
+
+	// Rescanning everything would have cost a full pass (27 rows/cols/boxes) for each kind of single.
+	// (count every g_N cells checked as one scan)
+	int numScans = (m_propagationStats.m_numUnitScans - numUnitScans) +
+		((m_propagationStats.m_numCellChecks - numCellChecks + g_N - 1) / g_N);
+	int numScansAvoided = (2 * NUM_COLLECTIONS * g_N) - numScans;
+	if (numScansAvoided > 0) {
+		m_propagationStats.m_numUnitScansAvoided += numScansAvoided;
+	}
+
+	if (foundSingle) {
+		return true;
+	}
+
+	// The queue is empty, so there aren't any singles.
+	// Try each of the other (more expensive) algorithms. Stop when one is successful.
+	// n.b., the chains are the last ones
+	int numAlgorithms = m_useChains ? NUM_ALGORITHMS : ALG_CHECK_FOR_X_CYCLES;
+	for (int i=ALG_CHECK_FOR_HIDDEN_SINGLES+1; i<numAlgorithms; i++) {
 		AlgorithmType algorithm = (AlgorithmType)i;
 
 		if (runAlgorithm(algorithm)) {
-			if (!validate()) {
+			// n.b., guesses made while searching are expected to go wrong, and checking the whole board
+			// after every step costs as much as some of the algorithms, so it's only done when tracing
+			if ((m_searchDepth == 0) && (g_debugLevel > 0) && !validate()) {
 				TRACE(0, "%s(algorithm=%s) INVALID solution!\n",
 					__CLASSFUNCTION__, algorithmToString(algorithm));
 			}
@@ -1923,6 +2178,15 @@ bool SudokuSolver::tryToSolve () {
 }
 
 void SudokuSolver::solve () {
+	if (m_solveMethod == SOLVE_METHOD_DANCING_LINKS) {
+		if (!solveWithDancingLinks()) {
+			TRACE(0, "%s() no solution!\n", __CLASSFUNCTION__);
+		}
+
+		print(g_debugLevel);
+		return;
+	}
+
 	while (1) {
 		print(g_debugLevel);
 
@@ -1931,11 +2195,292 @@ void SudokuSolver::solve () {
 		}
 
 		if (!tryToSolve()) {
-// TBD: unsolved!
-print();
+			// The logical algorithms are stuck, so start guessing
+			TRACE(1, "%s() no more logical steps, searching\n", __CLASSFUNCTION__);
+
+			if (!search()) {
+				TRACE(0, "%s() no solution!\n", __CLASSFUNCTION__);
+			}
+
+			TRACE(1, "%s() search took %d nodes\n", __CLASSFUNCTION__, m_numSearchNodes);
+
+			print(g_debugLevel);
+			break;
+		}
+	}
+
+	TRACE(1, "%s() %d steps, %d cell checks, %d unit scans, %d unit scans avoided, %d clean units skipped, %d clean values skipped\n", __CLASSFUNCTION__,
+		m_propagationStats.m_numSteps, m_propagationStats.m_numCellChecks,
+		m_propagationStats.m_numUnitScans, m_propagationStats.m_numUnitScansAvoided,
+		m_propagationStats.m_numCleanUnitsSkipped, m_propagationStats.m_numCleanDigitsSkipped);
+}
+
+// n.b., the algorithms are tried in order, so the hardest one is the last one that had any successes
+AlgorithmType SudokuSolver::rateDifficulty (DifficultyRating* rating) {
+	restoreClueGrid();
+	m_solverStats.reset();
+
+	bool useChains = m_useChains;
+	m_useChains = true;
+
+	bool needsSearch = false;
+	while (!isSolved()) {
+		if (!tryToSolve()) {
+			needsSearch = true;
+			break;
+		}
+	}
+
+	m_useChains = useChains;
+
+	AlgorithmType hardestAlgorithm = needsSearch ? NUM_ALGORITHMS : ALG_CHECK_FOR_NAKED_SINGLES;
+	for (int i=NUM_ALGORITHMS-1; !needsSearch && (i>0); i--) {
+		if (m_solverStats.m_algorithms[i].m_numSuccesses > 0) {
+			hardestAlgorithm = (AlgorithmType)i;
 			break;
 		}
 	}
+
+	if (rating) {
+		rating->reset();
+		rating->m_hardestAlgorithm = hardestAlgorithm;
+		rating->m_needsSearch = needsSearch;
+
+		for (int i=0; i<NUM_ALGORITHMS; i++) {
+			AlgorithmStats* stats = &m_solverStats.m_algorithms[i];
+
+			rating->m_numSteps[i] = stats->m_numSuccesses;
+			rating->m_numEliminations += stats->m_numEliminations;
+			rating->m_numPlacements += stats->m_numPlacements;
+		}
+	}
+
+	return hardestAlgorithm;
+}
+
+// Fill in the rest of the board using the exact cover engine
+bool SudokuSolver::solveWithDancingLinks () {
+	if (!m_dancingLinks) {
+		m_dancingLinks = new DancingLinks();
+	}
+
+	m_hasGuesses = true;
+
+	int grid[g_N * g_N];
+	int solution[g_N * g_N];
+
+	for (int row=0; row<g_N; row++) {
+		for (int col=0; col<g_N; col++) {
+			Cell* cell = m_allCells.getCell(row, col);
+
+			grid[(row * g_N) + col] = cell->getKnown() ? cell->getValue() : -1;
+		}
+	}
+
+	if (m_dancingLinks->solve(grid, solution) == 0) {
+		return false;
+	}
+
+	for (int row=0; row<g_N; row++) {
+		for (int col=0; col<g_N; col++) {
+			Cell* cell = m_allCells.getCell(row, col);
+
+			if (!cell->getKnown()) {
+				cell->setValue(solution[(row * g_N) + col]);
+			}
+		}
+	}
+
+	return true;
+}
+
+// Each cell's possible values (just the value, for known cells).
+// n.b., guesses aren't deductions, so a board that has them goes by the clues
+void SudokuSolver::getCandidates (CandidateMask candidates[g_N*g_N]) {
+	Grid* grid = m_hasGuesses ? &m_clueGrid : &m_grid;
+
+	for (int i=0; i<g_N*g_N; i++) {
+		PossibleValues* possibleValues = &grid->m_cells[i];
+
+		candidates[i] = possibleValues->getKnown() ? CandidateBit(possibleValues->getValue()) : possibleValues->getMask();
+	}
+}
+
+// n.b., with the bitmask engine
+uint64_t SudokuSolver::countSolutions (uint64_t limit) {
+	if (!m_boardSolver) {
+		m_boardSolver = new BoardSolver<g_n>();
+	}
+
+	CandidateMask candidates[g_N * g_N];
+	getCandidates(candidates);
+
+	return m_boardSolver->countSolutionsFrom(candidates, NULL, limit);
+}
+
+bool SudokuSolver::hasSolutionWithout (int cellIndex, int value) {
+	if (!m_boardSolver) {
+		m_boardSolver = new BoardSolver<g_n>();
+	}
+
+	CandidateMask candidates[g_N * g_N];
+	getCandidates(candidates);
+
+	return m_boardSolver->hasSolutionWithoutFrom(candidates, cellIndex, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Go back to what the clues rule out on their own.
+// n.b., none of that has been checked for singles, and candidates may have come back
+void SudokuSolver::restoreClueGrid () {
+	m_grid = m_clueGrid;
+	m_hasGuesses = false;
+
+	queueEverything();
+	setEverythingDirty();
+}
+
+int SudokuSolver::addClue (int cellIndex, int value) {
+	TRACE(3, "%s(cell=%d, value=%d)\n", __CLASSFUNCTION__, cellIndex, value+1);
+
+	if (m_hasGuesses) {
+		restoreClueGrid();
+	}
+
+	Cell* cell = m_allCells.getCell(cellIndex);
+	if ((m_clues[cellIndex] >= 0) || (cell->getKnown() ? (cell->getValue() != value) : !cell->isPossible(value))) {
+		return -1;
+	}
+
+	m_clues[cellIndex] = value;
+	m_clueGrid.setValue(cellIndex, value);
+
+	if (!cell->getKnown()) {
+		cell->setValue(value);
+	}
+
+	return 0;
+}
+
+// n.b., the other clues can't have the same value in the clue's row/col/box (or the puzzle wouldn't be valid),
+// so the value comes back to each unit, and to each of the peers that doesn't see it in another unit
+int SudokuSolver::removeClue (int cellIndex) {
+	TRACE(3, "%s(cell=%d)\n", __CLASSFUNCTION__, cellIndex);
+
+	int value = m_clues[cellIndex];
+	if (value < 0) {
+		return -1;
+	}
+
+	m_clues[cellIndex] = -1;
+
+	const CellIndex* units = g_topology.m_cellUnits[cellIndex];
+	for (int i=0; i<NUM_COLLECTIONS; i++) {
+		m_clueGrid.m_cellSets[units[i]].setPossible(CandidateBit(value));
+	}
+
+	m_clueGrid.recomputeCandidates(cellIndex);
+
+	const CellIndex* peers = g_topology.m_peers[cellIndex];
+	for (int i=0; i<BoardTopology::NUM_PEERS; i++) {
+		if (m_clues[peers[i]] < 0) {
+			m_clueGrid.recomputeCandidates(peers[i]);
+		}
+	}
+
+	// Anything worked out since might have depended on this clue
+	restoreClueGrid();
+
+	return 0;
+}
+
+bool SudokuSolver::hasContradiction () {
+	ForEachInCellSetCollectionArray(m_cellSetCollections, cellSetCollection) {
+		if (cellSetCollection->hasContradiction()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Run the logical algorithms until they're stuck.
+// return false if the board can't be solved from here
+bool SudokuSolver::propagate () {
+	while (!hasContradiction()) {
+		if (isSolved() || !tryToSolve()) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void SudokuSolver::saveState (SolverState* state) {
+	state->m_grid = m_grid;
+}
+
+// n.b., states are only saved once propagation is finished, so there's nothing to queue
+void SudokuSolver::restoreState (SolverState* state) {
+	clearQueue();
+
+	m_grid = state->m_grid;
+
+	// candidates have come back, so everything has to be looked at again
+	setEverythingDirty();
+}
+
+// Depth first search: guess a value for the cell with the fewest possible values,
+// let the logical algorithms run with it, and back up if that leads to a contradiction.
+// return true (with the board solved) if a solution was found
+bool SudokuSolver::search () {
+	m_numSearchNodes++;
+	m_hasGuesses = true;
+
+	if (!propagate()) {
+		return false;
+	}
+
+	Cell* cell = m_allCells.findMostConstrainedCell();
+	if (!cell) {
+		return true; // solved!
+	}
+
+	SolverState state;
+	saveState(&state);
+
+	ForEachCandidate(cell->getPossibleMask(), value) {
+		TRACE(2, "%s(depth=%d) trying %s=%d\n",
+			__CLASSFUNCTION__, m_searchDepth, cell->getName().c_str(), value+1);
+
+		m_searchDepth++;
+		cell->setValue(value);
+		bool solved = search();
+		m_searchDepth--;
+
+		if (solved) {
+			return true;
+		}
+
+		restoreState(&state);
+	}
+
+	return false;
+}
+
+void SudokuSolver::getGameString (char buffer[g_N*g_N+1]) {
+	char* p = buffer;
+
+	for (int row=0; row<g_N; row++) {
+		for (int col=0; col<g_N; col++) {
+			Cell* cell = m_allCells.getCell(row, col);
+
+			*p++ = cell->getKnown() ? ('1' + cell->getValue()) : '.';
+		}
+	}
+
+	*p = '\0';
 }
 
 void SudokuSolver::print (int level) {
@@ -1954,6 +2499,34 @@ bool SudokuSolver::validate (int level) {
 	return valid;
 }
 
+void SolverStats::print (FILE* fp) {
+	AlgorithmStats total;
+	memset(&total, 0, sizeof(total));
+
+	fprintf(fp, "%-28s %10s %10s %6s %12s %10s %10s\n",
+		"algorithm", "calls", "successes", "hit%", "eliminations", "placements", "msec");
+
+	for (int i=0; i<=NUM_ALGORITHMS; i++) {
+		AlgorithmStats* stats = (i < NUM_ALGORITHMS) ? &m_algorithms[i] : &total;
+
+		if (i < NUM_ALGORITHMS) {
+			total.m_numInvocations += stats->m_numInvocations;
+			total.m_numSuccesses += stats->m_numSuccesses;
+			total.m_numEliminations += stats->m_numEliminations;
+			total.m_numPlacements += stats->m_numPlacements;
+			total.m_numNanoseconds += stats->m_numNanoseconds;
+		}
+
+		double hitRate = (stats->m_numInvocations > 0) ?
+			(100.0 * stats->m_numSuccesses / stats->m_numInvocations) : 0.0;
+
+		fprintf(fp, "%-28s %10d %10d %5.1f%% %12d %10d %10.3f\n",
+			(i < NUM_ALGORITHMS) ? algorithmToString((AlgorithmType)i) : "total",
+			stats->m_numInvocations, stats->m_numSuccesses, hitRate,
+			stats->m_numEliminations, stats->m_numPlacements, stats->m_numNanoseconds / 1e6);
+	}
+}
+
 void SudokuSolver::listAlgorithms () {
 	printf("Algorithm numbers:\n");
 	for (int i=0; i<NUM_ALGORITHMS; i++) {
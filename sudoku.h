@@ -3,16 +3,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 
+#include <string>
 #include <vector>
 
 #include "Common.h"
 
+#include "Topology.h"
+#include "Combinations.h"
+
 ////////////////////////////////////////////////////////////////////////////////
 
 #define g_n									3 // Boxes are 3x3
 #define g_N									(g_n * g_n)	// 9 cells in a row, col or box
 
+// Rows, cols, boxes, peers and intersections for the board, shared by every solver
+typedef Topology<g_n>						BoardTopology;
+typedef BoardTopology::CellIndex			CellIndex;
+
+inline constexpr BoardTopology				g_topology;
+
+// Subsets of the g_N cells in a row/col/box (or of the g_N values), by size, for the subset searches
+inline constexpr CombinationTable<g_N>		g_combinations;
+
 class Cell;
 typedef std::vector<Cell*>					CellVector;
 typedef CellVector::iterator				CellVectorIterator;
@@ -22,11 +36,30 @@ typedef std::vector<CellSet*>				CellSetVector;
 typedef CellSetVector::iterator				CellSetVectorIterator;
 
 class CellSetCollection;
+class SudokuSolver;
+class DancingLinks;
+class ImplicationGraph;
+template <int n> class BoardSolver;
 typedef std::vector<CellSetCollection*>		CellSetCollectionVector;
 typedef CellSetCollectionVector::iterator	CellSetCollectionVectorIterator;
 
 typedef std::vector<int>					IntVector;
 
+// Candidate values are kept as a bitmask: bit "i" is set if value "i" is possible
+typedef uint16_t							CandidateMask;
+
+#define ALL_CANDIDATES						((CandidateMask)((1 << g_N) - 1))
+#define CandidateBit(value)					((CandidateMask)(1 << (value)))
+
+inline int countCandidates (CandidateMask mask) { return __builtin_popcount(mask); }
+inline int firstCandidate (CandidateMask mask) { return __builtin_ctz(mask); }
+
+// Visit each value in a CandidateMask, lowest first
+#define ForEachCandidate(mask, varName)							\
+	for (int varName ## _m=(mask), varName=0; varName ## _m && ((varName=firstCandidate(varName ## _m)), true); varName ## _m &= varName ## _m - 1)
+
+extern std::string candidatesToString (CandidateMask mask);
+
 typedef enum {
 	ALG_CHECK_FOR_NAKED_SINGLES,
 	ALG_CHECK_FOR_HIDDEN_SINGLES,
@@ -42,11 +75,16 @@ typedef enum {
 	ALG_CHECK_FOR_SINGLES_CHAINS,
 	ALG_CHECK_FOR_SWORDFISH,
 	ALG_CHECK_FOR_XYZ_WINGS,
+	ALG_CHECK_FOR_JELLYFISH,
+	ALG_CHECK_FOR_FINNED_FISH,
+	ALG_CHECK_FOR_X_CYCLES,
+	ALG_CHECK_FOR_XY_CHAINS,
+	ALG_CHECK_FOR_AICS,
 
 	NUM_ALGORITHMS
 } AlgorithmType;
 
-extern const char* alogorithmToString (AlgorithmType);
+extern const char* algorithmToString (AlgorithmType);
 
 typedef enum {
 	ROW_COLLECTION,
@@ -59,12 +97,20 @@ typedef enum {
 extern const char* collectionToString (CollectionType);
 
 typedef enum {
-	CHAIN_STATUS_UNCOLORED,
-	CHAIN_STATUS_COLOR_RED,
-	CHAIN_STATUS_COLOR_BLACK
-} ChainStatusType;
+	CHAIN_COLOR_RED,
+	CHAIN_COLOR_BLACK,
 
-extern const char* chainStatusToString (ChainStatusType);
+	NUM_CHAIN_COLORS
+} ChainColorType;
+
+extern const char* chainColorToString (ChainColorType);
+
+typedef enum {
+	SOLVE_METHOD_TECHNIQUES,		// the logical algorithms, with a backtracking search if they get stuck
+	SOLVE_METHOD_DANCING_LINKS,		// exact cover, straight to the answer
+
+	NUM_SOLVE_METHODS
+} SolveMethodType;
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -81,10 +127,8 @@ class IntList : public IntVector {
 
 		bool							onList (int value);
 
-		const char*						toString ();
+		std::string						toString ();
 
-		static IntList					findIntersection (IntList& listA, IntList& listB);
-		void							findUnion (IntList& otherList);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -95,7 +139,7 @@ class CellList : public CellVector {
 		Cell*							getValue (int i);
 		int								getLength ();
 
-		const char*						toString ();
+		std::string						toString ();
 
 		bool							onList (Cell* cell);
 };
@@ -112,27 +156,134 @@ class PossibleValues {
 		int								getValue () { return m_value; }
 		bool							getKnown () { return m_known; }
 
-		void							setNoLongerPossible (int value);
-
-		bool							isPossible (int value);
+		void							setNoLongerPossible (int value) { m_mask &= ~CandidateBit(value); }
+		void							setNoLongerPossible (CandidateMask values) { m_mask &= ~values; }
+		void							setPossible (CandidateMask values) { m_mask |= values; }
 
-		IntList*						getList () { return &m_list; }
+		bool							isPossible (int value) { return !m_known && (m_mask & CandidateBit(value)); }
 
-		void							adjustList ();
+		CandidateMask					getMask () { return m_known ? 0 : m_mask; }
+		int								getNumPossible () { return countCandidates(getMask()); }
 
 	protected:
+		// kept small (4 bytes) so that the whole board fits in a few cache lines
+		CandidateMask					m_mask;
+		int8_t							m_value;
 		bool							m_known;
-		int								m_value;
-		bool							m_possibleValues[g_N];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A 9-bit mask of positions within a row/col/box: bit "i" is the i'th cell
+typedef uint16_t							LocationMask;
+
+#define ALL_LOCATIONS						((LocationMask)((1 << g_N) - 1))
+
+// One bit per cell (row by row), laid out like g_topology.m_peerMasks
+struct CellMask {
+	uint64_t							m_words[BoardTopology::NUM_PEER_WORDS];
+
+	void								reset () {
+											for (int i=0; i<BoardTopology::NUM_PEER_WORDS; i++) {
+												m_words[i] = 0;
+											}
+										}
+
+	void								set (int cell) { m_words[cell / 64] |= ((uint64_t)1 << (cell % 64)); }
+	void								clear (int cell) { m_words[cell / 64] &= ~((uint64_t)1 << (cell % 64)); }
+	bool								has (int cell) const { return (m_words[cell / 64] >> (cell % 64)) & 1; }
+
+	bool								isEmpty () const {
+											for (int i=0; i<BoardTopology::NUM_PEER_WORDS; i++) {
+												if (m_words[i]) {
+													return false;
+												}
+											}
+
+											return true;
+										}
+
+	// return the lowest cell in the mask (which must not be empty), and take it out
+	int									removeFirst () {
+											int i = 0;
+											while (!m_words[i]) {
+												i++;
+											}
 
-		IntList							m_list;
+											int cell = (i * 64) + __builtin_ctzll(m_words[i]);
+											m_words[i] &= m_words[i] - 1;
+
+											return cell;
+										}
+
+	CellMask							operator& (const CellMask& other) const {
+											CellMask result;
+											for (int i=0; i<BoardTopology::NUM_PEER_WORDS; i++) {
+												result.m_words[i] = m_words[i] & other.m_words[i];
+											}
+
+											return result;
+										}
+
+	CellMask							operator| (const CellMask& other) const {
+											CellMask result;
+											for (int i=0; i<BoardTopology::NUM_PEER_WORDS; i++) {
+												result.m_words[i] = m_words[i] | other.m_words[i];
+											}
+
+											return result;
+										}
+
+	static CellMask						peersOf (int cell) {
+											CellMask result;
+											for (int i=0; i<BoardTopology::NUM_PEER_WORDS; i++) {
+												result.m_words[i] = g_topology.m_peerMasks[cell][i];
+											}
+
+											return result;
+										}
+};
+
+// Everything the solver knows about the board, in one contiguous block:
+// the candidates for each cell (row by row) and the known values of each row/col/box
+// (indexed by CellSet::getIndex()). The Cells and CellSets point into it.
+//
+// m_locations is the same candidates, digit-major: where each value is still possible in each
+// row/col/box. SudokuSolver::cellChanged() keeps it in sync with m_cells.
+// So does the index of cells with only 2 (or 3) possible values, for the wings.
+struct Grid {
+	PossibleValues						m_cells[g_N * g_N];
+	PossibleValues						m_cellSets[NUM_COLLECTIONS * g_N];
+	LocationMask						m_locations[NUM_COLLECTIONS * g_N][g_N];
+
+	CellMask							m_bivalueCells[g_N];	// cells with 2 possible values, one of which is the value
+	CellMask							m_trivalueCells;		// cells with 3 possible values
+
+	// Keep m_locations and the bivalue/trivalue indexes in sync with a cell whose "changedValues"
+	// just came back or went away
+	void								updateIndexes (int cell, CandidateMask changedValues);
+
+	// Changes that go straight to the grid, without the Cells (so nothing gets queued or marked dirty):
+	// place a value and rule it out of the cell's peers, or give a cell back whatever none of its
+	// rows/cols/boxes has
+	void								setValue (int cell, int value);
+	void								recomputeCandidates (int cell);
 };
 
+// One singles chain for a value: the cells of each color, and where they are in each row/col/box
+struct SinglesChain {
+	CellMask							m_cells[NUM_CHAIN_COLORS];
+	LocationMask						m_locations[NUM_CHAIN_COLORS][NUM_COLLECTIONS * g_N];
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 class Cell {
 	public:
-										Cell (int row, int col);
+										Cell () { }
+
+		void							init (int row, int col);
 
 		void							reset ();
 		void							setValue (int value);
@@ -143,26 +294,32 @@ class Cell {
 											m_cellSets[collection] = cellSet;
 										}
 
-		bool							getKnown () { return m_possibleValues.getKnown(); }
-		int								getValue () { return m_possibleValues.getValue(); }
+		void							setSolver (SudokuSolver* solver) { m_solver = solver; }
+		AlgorithmType					getCurrentAlgorithm ();
+
+		void							setPossibleValues (PossibleValues* possibleValues) { m_possibleValues = possibleValues; }
+
+		bool							getKnown () { return m_possibleValues->getKnown(); }
+		int								getValue () { return m_possibleValues->getValue(); }
+
+		PossibleValues*					getPossibleValues () { return m_possibleValues; }
 
 		bool							hasNeighbor (Cell* otherCell);
 		bool							haveExactPossibles (Cell* otherCell);
 		bool							processNakedSingle ();
-		IntList*						getPossibleValuesList () { return m_possibleValues.getList(); }
+		CandidateMask					getPossibleMask () { return m_possibleValues->getMask(); }
+		int								getNumPossible () { return m_possibleValues->getNumPossible(); }
 		bool							haveSamePossibles (Cell* otherCell);
 		bool							haveAnyOverlappingPossibles (Cell* otherCell);
-		bool							areAnyOfTheseValuesPossible (IntList&);
-		bool							hiddenSubsetReduction (IntList&);
-		bool							hiddenSubsetReduction2 (CellList& candidateCells, IntList&);
+		bool							areAnyOfTheseValuesPossible (CandidateMask);
+		bool							hiddenSubsetReduction (CandidateMask);
+		bool							hiddenSubsetReduction2 (CellList& candidateCells, CandidateMask);
 		bool							checkForYWings ();
-		bool							checkForYWings (Cell* cell2);
 		bool							checkForYWingReductions (int c, Cell* otherCell);
 		bool							checkForXYZWings ();
-		bool							checkForXYZWings (Cell* cell2);
 		bool							checkForXYZReductions (int candidate, Cell* cell2, Cell* cell3);
 
-		bool							tryToReduce (IntList& values, AlgorithmType=NUM_ALGORITHMS);
+		bool							tryToReduceCandidates (CandidateMask values, AlgorithmType=NUM_ALGORITHMS);
 		bool							tryToReduce (int candidate, AlgorithmType=NUM_ALGORITHMS);
 
 										// Get the row/col/box
@@ -175,28 +332,23 @@ class Cell {
 		int								getRow () { return m_row; }
 		int								getCol () { return m_col; }
 		int								getBox () { return m_box; }
+		int								getIndex () { return (m_row * g_N) + m_col; }
 
 		CellSet*						getCellSet (CollectionType collection) { return m_cellSets[collection]; }
 
-		std::string						getName () { return m_name; }
-
-		// For chain coloring
-		void							resetChain ();
-		bool							buildChains (int candidate, ChainStatusType, Cell* linkingCell);
-		ChainStatusType					getChainStatus () { return m_chainStatus; }
-		bool							isConjugatePair (int candidate);
-		bool							canSee (ChainStatusType);
+		// n.b., only for tracing, so it's built on demand
+		std::string						getName () { return makeString("R%dC%d", m_row+1, m_col+1); }
 
 	protected:
-		void							adjustPossibleValuesList ();
+		void							candidatesChanged (CandidateMask changedValues);
 
 	protected:
-		std::string						m_name;
 		int								m_row;
 		int								m_col;
 		int								m_box;
 
-		PossibleValues					m_possibleValues;
+		// This cell's entry in the solver's Grid
+		PossibleValues*					m_possibleValues;
 
 		// This cell is part of 3 collections:
 		// 1) a row
@@ -205,8 +357,8 @@ class Cell {
 		// m_cellSets provides a back pointer to those structures
 		CellSet*						m_cellSets[NUM_COLLECTIONS];
 
-		// For chain coloring
-		ChainStatusType					m_chainStatus;
+		// The solver this cell belongs to (so we know which algorithm is running)
+		SudokuSolver*					m_solver;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -215,7 +367,9 @@ class CellSet {
 	friend class Cell;
 
 	public:
-										CellSet (CollectionType collection, std::string name);
+										CellSet () { }
+
+		void							init (CollectionType collection, int index);
 
 		void							reset ();
 
@@ -225,158 +379,134 @@ class CellSet {
 											cell->setCellSet(m_collection, this);
 										}
 
+		void							setSolver (SudokuSolver* solver) { m_solver = solver; }
+		void							setGrid (Grid* grid) {
+											m_grid = grid->m_cells;
+											m_possibleValues = &grid->m_cellSets[getIndex()];
+											m_locations = grid->m_locations[getIndex()];
+										}
+
+		// Dirty tracking: has anything in this CellSet changed since the current algorithm last looked at it?
+		bool							needsScan ();
+		void							setDirty () { m_cleanAlgorithms = 0; }
+
 		Cell*							getCell (int i) {
 											return m_cells[i];
 										}
 
 		void							setNoLongerPossible (int value);
-		IntList*						getPossibleValuesList () { return m_possibleValues.getList(); }
+		CandidateMask					getPossibleMask () { return m_possibleValues->getMask(); }
+		PossibleValues*					getPossibleValues () { return m_possibleValues; }
+
+		// Bit "i" is set if the i'th cell could be "value" / any of "values" (straight from the Grid)
+		LocationMask					getLocations (int value) { return m_locations[value]; }
+		LocationMask					getLocationsMask (CandidateMask values);
 
-		void							getBoxCells (Cell* boxCells[], bool isRow, int i);
 		bool							cellInSet (Cell* cell, Cell* cellSet[]);
-		bool							checkForLockedCandidates ();
-		bool							checkForLockedCandidate (int c);
-		bool							checkForLockedCandidate2 (int candidate, CollectionType collection, IntList& locations);
-		bool							inSameRCB (CollectionType collection, IntList& locations);
-		bool							lockedCandidateReduction (int candidate, CellList& cellList);
 		CellList						findCellsWithSamePossibleValues (Cell* cellToMatch);
-		bool							checkForXWingReductions (int candidate, IntList& locations);
+
+		// Eliminate "candidate" from the cells in "locations"
+		bool							tryToReduceLocations (int candidate, LocationMask locations);
 
 		bool							runAlgorithm (AlgorithmType algorithm);
 		bool							checkForNakedSubsets (int n);
-		bool							nakedSubsetReduction (CellList& cellList, IntList& values);
+		bool							nakedSubsetReduction (CellList& cellList, CandidateMask values);
 		bool							checkForHiddenSubsets (int n);
-		bool							checkForHiddenSubsets (IntList& permutation);
-		bool							hiddenSubsetReduction (IntList& permutation);
-		bool							hiddenSubsetReduction2 (CellList& candidateCells, IntList& permutation);
-		IntList							getLocationsForCandidate (int candidate);
+		bool							checkForHiddenSubsets (CandidateMask permutation);
+		bool							hiddenSubsetReduction2 (CellList& candidateCells, CandidateMask permutation);
 
 		bool							hasCandidateCell (Cell* candidateCell);
 		bool							hasAllCandidateCells (CellList& candidateCells);
 
 		bool							validate (int level=0);
+		bool							hasContradiction ();
 
-		std::string						getName () { return m_name; }
+		// n.b., only for tracing, so it's built on demand
+		std::string						getName () { return makeString("%s%d", collectionToString(m_collection), m_index+1); }
 
-		std::string						toString (int level);
+		// 0..(NUM_COLLECTIONS*g_N)-1, unique across all of the collections
+		int								getIndex () { return (m_collection * g_N) + m_index; }
 
-		// For chain coloring
-		void							buildChains (int candidate, ChainStatusType, Cell* linkingCell);
-		bool							checkForSinglesChainsReductions (int candidate);
-		int								getNumPossible (int candidate);
-		bool							checkChainStatus (ChainStatusType);
-		int								getChainStatusCount (ChainStatusType);
+		std::string						toString (int level);
 
 	protected:
 		CollectionType					m_collection;
-		std::string						m_name;
+		int								m_index;
 
-		PossibleValues					m_possibleValues;
+		// This CellSet's entry in the solver's Grid, and the start of the Grid's cells
+		PossibleValues*					m_possibleValues;
+		PossibleValues*					m_grid;
+		const CellIndex*				m_cellIndexes; // into m_grid (from g_topology)
+		LocationMask*					m_locations; // by value
 
 		Cell*							m_cells[g_N];
+
+		SudokuSolver*					m_solver;
+
+		// bit "a" is set if algorithm "a" scanned this CellSet and nothing has changed since
+		uint32_t						m_cleanAlgorithms;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
 class CellSetCollection {
 	public:
-										CellSetCollection (CollectionType type, std::string name) {
+										CellSetCollection (CollectionType type) {
 											m_type = type;
-											m_name = makeString("All%ss", name.c_str());
 
 											for (int i=0; i<g_N; i++) {
-												m_cellSets[i] = new CellSet(m_type, makeString("%s%d", name.c_str(), i+1));
+												m_cellSets[i].init(m_type, i);
 											}
 										}
 
-										virtual ~CellSetCollection () {
-											for (int i=0; i<g_N; i++) {
-												delete m_cellSets[i];
-											}
-										}
+										virtual ~CellSetCollection () { }
 
 		void							reset ();
 
-		void							setCell (int row, int col, Cell* cell) {
-											int index1 = getIndex1(row, col);
-											int index2 = getIndex2(row, col);
-		
-											CellSet* cellSet = m_cellSets[index1];
-											cellSet->setCell(index2, cell);
-										}
-
 		CellSet*						getCellSet (int i) {
-											return m_cellSets[i];
+											return &m_cellSets[i];
 										}
 
-		bool							checkForLockedCandidates ();
+		// n.b., only for tracing, so it's built on demand
+		std::string						getName () { return makeString("All%ss", collectionToString(m_type)); }
+
 		bool							checkForNakedSubsets (int n);
 		bool							checkForHiddenSubsets (int n);
-		virtual bool					checkForXWings (int n, int candidate);
-
-		// For chain coloring
-		bool							checkForSinglesChainsReductions (int candidate);
-		bool							checkForTwoOfTheSameColor (ChainStatusType);
+		virtual bool					checkForFish (int n, int candidate, bool finned=false);
 
 		bool							validate (int level=0);
+		bool							hasContradiction ();
 
 		void							print (int level);
 
 	protected:
-		virtual int						getIndex1 (int row, int col) = 0;
-		virtual int						getIndex2 (int row, int col) = 0;
-
 		CollectionType					m_type;
 
-		std::string						m_name;
-		CellSet*						m_cellSets[g_N];
+		CellSet							m_cellSets[g_N];
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
 class AllRows : public CellSetCollection {
 	public:
-										AllRows () : CellSetCollection(ROW_COLLECTION, "Row") { }
-
-		int								getIndex1 (int row, int col) { return row; }
-		int								getIndex2 (int row, int col) { return col; }
+										AllRows () : CellSetCollection(ROW_COLLECTION) { }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
 class AllCols : public CellSetCollection {
 	public:
-										AllCols () : CellSetCollection(COL_COLLECTION, "Col") { }
-
-		int								getIndex1 (int row, int col) { return col; }
-		int								getIndex2 (int row, int col) { return row; }
+										AllCols () : CellSetCollection(COL_COLLECTION) { }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
 class AllBoxes : public CellSetCollection {
 	public:
-										AllBoxes () : CellSetCollection(BOX_COLLECTION, "Box") { }
-
-		int								getIndex1 (int row, int col) {
-											int rowBase = row / g_n;
-											int colBase = col / g_n;
-
-											int index = (rowBase * g_n) + colBase;
-
-											return index;
-										}
+										AllBoxes () : CellSetCollection(BOX_COLLECTION) { }
 
-		int								getIndex2 (int row, int col) {
-											int rowBase = row % g_n;
-											int colBase = col % g_n;
-
-											int index = (rowBase * g_n) + colBase;
-
-											return index;
-										}
-
-		bool							checkForXWings (int n, int candidate) { return false; }
+		// n.b., fish are only made of rows and cols
+		bool							checkForFish (int n, int candidate, bool finned=false) { return false; }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -386,23 +516,19 @@ class AllCells {
 										AllCells () {
 											for (int row=0; row<g_N; row++) {
 												for (int col=0; col<g_N; col++) {
-													Cell* cell = new Cell(row, col);
-
-													int index = getIndex(row, col);
-													m_cells[index] = cell;
+													m_cells[getIndex(row, col)].init(row, col);
 												}
 											}
 										}
 
-										~AllCells () {
-										}
-
 		Cell*							getCell (int row, int col) {
 											int index = getIndex(row, col);
 
-											return m_cells[index];
+											return &m_cells[index];
 										}
 
+		Cell*							getCell (int index) { return &m_cells[index]; }
+
 		bool							isSolved () {
 											for (int row=0; row<g_N; row++) {
 												for (int col=0; col<g_N; col++) {
@@ -417,19 +543,89 @@ class AllCells {
 											return true;
 										}
 
-		bool							checkForYWings ();
-		bool							checkForXYZWings ();
-
-		// For chain coloring
-		void							resetChains ();
-		bool							buildChains (int candidate, ChainStatusType);
+		Cell*							findMostConstrainedCell ();
 
 	protected:
 		int								getIndex (int row, int col) {
 											return (row * g_N) + col;
 										}
 
-		Cell*							m_cells[g_N * g_N];
+		Cell							m_cells[g_N * g_N];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A snapshot of everything the solver knows about the board, for backtracking
+struct SolverState {
+	Grid								m_grid;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+// How much work the propagation queue did (and saved)
+struct PropagationStats {
+	int									m_numSteps;				// calls to tryToSolve()
+	int									m_numCellChecks;		// cells checked for naked singles
+	int									m_numUnitScans;			// rows/cols/boxes scanned for hidden singles
+	int									m_numUnitScansAvoided;	// vs. rescanning all 27 for both kinds of singles every step
+	int									m_numCleanUnitsSkipped;	// rows/cols/boxes an algorithm didn't have to rescan
+	int									m_numCleanDigitsSkipped;	// values an algorithm didn't have to rescan
+
+										PropagationStats () { reset(); }
+
+	void								reset () { memset(this, 0, sizeof(*this)); }
+	void								add (PropagationStats& other) {
+											m_numSteps += other.m_numSteps;
+											m_numCellChecks += other.m_numCellChecks;
+											m_numUnitScans += other.m_numUnitScans;
+											m_numUnitScansAvoided += other.m_numUnitScansAvoided;
+											m_numCleanUnitsSkipped += other.m_numCleanUnitsSkipped;
+											m_numCleanDigitsSkipped += other.m_numCleanDigitsSkipped;
+										}
+};
+
+// What each algorithm costs, and how often it pays off
+struct AlgorithmStats {
+	int									m_numInvocations;
+	int									m_numSuccesses;			// invocations that changed something
+	int									m_numEliminations;		// candidates removed
+	int									m_numPlacements;		// cells solved
+	uint64_t							m_numNanoseconds;		// time spent in runAlgorithm()
+};
+
+// Per-algorithm counters for one solver. Batch workers each have their own, and add() them up at the end
+struct SolverStats {
+	AlgorithmStats						m_algorithms[NUM_ALGORITHMS];
+
+										SolverStats () { reset(); }
+
+	void								reset () { memset(this, 0, sizeof(*this)); }
+	void								add (SolverStats& other) {
+											for (int i=0; i<NUM_ALGORITHMS; i++) {
+												AlgorithmStats* stats = &m_algorithms[i];
+												AlgorithmStats* otherStats = &other.m_algorithms[i];
+
+												stats->m_numInvocations += otherStats->m_numInvocations;
+												stats->m_numSuccesses += otherStats->m_numSuccesses;
+												stats->m_numEliminations += otherStats->m_numEliminations;
+												stats->m_numPlacements += otherStats->m_numPlacements;
+												stats->m_numNanoseconds += otherStats->m_numNanoseconds;
+											}
+										}
+	void								print (FILE* fp);
+};
+
+// How hard a puzzle is for the logical algorithms (see rateDifficulty())
+struct DifficultyRating {
+	AlgorithmType						m_hardestAlgorithm;		// NUM_ALGORITHMS if they weren't enough
+	bool								m_needsSearch;			// the algorithms got stuck before it was solved
+	int									m_numSteps[NUM_ALGORITHMS];	// times each algorithm changed something
+	int									m_numEliminations;		// candidates removed, by all of them
+	int									m_numPlacements;		// cells solved, by all of them
+
+										DifficultyRating () { reset(); }
+
+	void								reset () { memset(this, 0, sizeof(*this)); }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -437,32 +633,108 @@ class AllCells {
 class SudokuSolver {
 	public:
 										SudokuSolver ();
+										~SudokuSolver ();
 
 		int								loadGameFile (const char* filename);
 		int								loadGameString (const char* gameString);
+
+		// Change the puzzle a clue at a time (for generators, minimality checks, etc.), without reloading it.
+		// Adding a clue keeps everything that's been worked out so far, since it's all still true with more clues.
+		// Taking one away goes back to what the other clues rule out on their own, and only the cell and its
+		// peers have to be recomputed.
+		// return 0, or -1 if the clue contradicts the board (or there's no clue in the cell to remove)
+		int								addClue (int cellIndex, int value);
+		int								removeClue (int cellIndex);
+		int								getClue (int cellIndex) { return m_clues[cellIndex]; }
+
 		int								checkGameFile (const char* filename);
 		int								checkGameString (const char* gameString);
 		void							solve ();
 		bool							tryToSolve ();
+
+		// Solve with the logical algorithms alone (no guessing), and fill in "rating" (if it's not NULL)
+		// with what each of them did along the way.
+		// n.b., it always starts over from the clues (with the per-algorithm counters cleared), so anything
+		// done to the board since it was loaded (solve(), steps, etc.) doesn't count.
+		// return the hardest algorithm that was needed, or NUM_ALGORITHMS if they weren't enough
+		AlgorithmType					rateDifficulty (DifficultyRating* rating=NULL);
+
+		// Propagation queue: cells and rows/cols/boxes that changed since they were last checked for singles
+		void							cellChanged (Cell* cell, CandidateMask changedValues=ALL_CANDIDATES);
+		void							queueEverything ();
+		void							clearQueue ();
+		bool							processQueue ();
+		PropagationStats*				getPropagationStats () { return &m_propagationStats; }
+		SolverStats*					getSolverStats () { return &m_solverStats; }
+
+		Cell*							getCell (int index) { return m_allCells.getCell(index); }
+		CellSet*						getCellSet (int unit) { return m_cellSetCollections[unit / g_N]->getCellSet(unit % g_N); }
+
+		// The cells with 2 possible values (one of them "value"), and with 3 possible values
+		const CellMask&					getBivalueCells (int value) { return m_grid.m_bivalueCells[value]; }
+		const CellMask&					getTrivalueCells () { return m_grid.m_trivalueCells; }
+
+		// Dirty tracking, for algorithms that work a value at a time (or on the whole board)
+		bool							needsDigitScan (int value);
+		bool							needsBoardScan ();
+		void							setEverythingDirty ();
+
+		void							setSolveMethod (SolveMethodType solveMethod) { m_solveMethod = solveMethod; }
+		SolveMethodType					getSolveMethod () { return m_solveMethod; }
+
+		// Whether tryToSolve() goes on to the chains (X-cycles, XY-chains and AICs) before giving up.
+		// They're off by default: on a 9x9 board, the backtracking search gets there sooner than they do.
+		// n.b., rateDifficulty() always uses them
+		void							setUseChains (bool useChains) { m_useChains = useChains; }
+		bool							getUseChains () { return m_useChains; }
+		bool							solveWithDancingLinks ();
+
+		// How many solutions the board has (starting from whatever's been worked out so far), stopping at "limit"
+		// (NO_SOLUTION_LIMIT to count them all). The board itself isn't changed.
+		uint64_t						countSolutions (uint64_t limit);
+
+		// Is there a solution without "value" in the cell? For a puzzle with exactly one solution, that's
+		// whether taking that clue away would leave more than one (and it's a lot quicker than counting them).
+		bool							hasSolutionWithout (int cellIndex, int value);
+		void							getCandidates (CandidateMask candidates[g_N*g_N]);
+
+		// Backtracking, for when the logical algorithms get stuck
+		bool							search ();
+		bool							propagate ();
+		bool							hasContradiction ();
+		void							saveState (SolverState* state);
+		void							restoreState (SolverState* state);
+		int								getNumSearchNodes () { return m_numSearchNodes; }
+
 		bool							runAlgorithm (AlgorithmType algorithm);
+		bool							runAlgorithmInternal (AlgorithmType algorithm);
+		void							algorithmFinished (AlgorithmType algorithm, bool success, uint64_t startTime);
+		AlgorithmType					getCurrentAlgorithm () { return m_currentAlgorithm; }
 		bool							checkForNakedSubsets (int n);
 		bool							checkForHiddenSubsets (int n);
 		bool							checkForLockedCandidates ();
-		bool							checkForXWings (int n);
+		bool							checkForFish (int n);
+		bool							checkForFinnedFish ();
 		bool							checkForYWings ();
 		bool							checkForXYZWings ();
 
 		// For singles chains
 		bool							checkForSinglesChains ();
 		bool							checkForSinglesChains (int candidate);
-		bool							singlesChainsReduction (int candidate, ChainStatusType);
-		bool							checkForSinglesChainsReductions_SameColor (int candidate, ChainStatusType);
-		bool							checkForSinglesChainsReductions_DifferentColors (int candidate);
-		void							printColors();
+		void							buildSinglesChain (int candidate, int firstCell, CellMask* unchainedCells, SinglesChain* chain);
+		bool							checkForSinglesChainsReductions (int candidate, SinglesChain* chain, const CellMask& cellsWithCandidate);
+		void							printColors (SinglesChain* chain);
+
+		// For X-cycles, XY-chains and AICs (alternating inference chains)
+		bool							checkForChains (AlgorithmType algorithm);
+		bool							chainReduction (int node1, int node2);
 
 		void							reset ();
 		void							print (int level=0);
 
+		// One character per cell, row by row ('.' for unknown cells), NUL terminated
+		void							getGameString (char buffer[g_N*g_N+1]);
+
 		bool							isSolved () {
 											return m_allCells.isSolved();
 										}
@@ -472,6 +744,15 @@ class SudokuSolver {
 		void							listAlgorithms ();
 
 	protected:
+		Grid							m_grid;
+
+		// The clues, and what they rule out on their own (without any of the algorithms)
+		int8_t							m_clues[g_N * g_N]; // -1 if the cell isn't a clue
+		Grid							m_clueGrid;
+		bool							m_hasGuesses; // m_grid has guesses in it (from a search or the exact cover engine)
+
+		void							restoreClueGrid ();
+
 		AllCells						m_allCells;
 
 		AllRows							m_allRows;
@@ -479,4 +760,30 @@ class SudokuSolver {
 		AllBoxes						m_allBoxes;
 
 		CellSetCollection*				m_cellSetCollections[NUM_COLLECTIONS];
+
+		AlgorithmType					m_currentAlgorithm;
+
+		int								m_searchDepth;
+		int								m_numSearchNodes;
+
+		// n.b., each cell/CellSet is on its queue at most once
+		Cell*							m_cellQueue[g_N * g_N];
+		int								m_cellQueueLength;
+		bool							m_cellQueued[g_N * g_N];
+
+		CellSet*						m_cellSetQueue[NUM_COLLECTIONS * g_N];
+		int								m_cellSetQueueLength;
+		bool							m_cellSetQueued[NUM_COLLECTIONS * g_N];
+
+		PropagationStats				m_propagationStats;
+		SolverStats						m_solverStats;
+
+		// bit "v" is set if the algorithm scanned value "v" and no "v" has been eliminated since
+		CandidateMask					m_cleanValues[NUM_ALGORITHMS];
+
+		SolveMethodType					m_solveMethod;
+		bool							m_useChains;
+		DancingLinks*					m_dancingLinks; // created the first time it's needed
+		ImplicationGraph*				m_implicationGraph; // created the first time it's needed
+		BoardSolver<g_n>*				m_boardSolver; // created the first time it's needed
 };